@@ -7,15 +7,27 @@
 #include <cstdio>
 #include <cstring>
 #include <climits>
+#include <exception>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 #include "GamsBonmin.hpp"
 #include "GamsMINLP.hpp"
+#include "GamsNLPCache.hpp"
+#include "GamsOACuts.hpp"
+#include "GamsMIQCP.hpp"
 #include "GamsJournal.hpp"
+#include "GamsLinearSolver.hpp"
 #include "GamsMessageHandler.hpp"
 #include "GamsCbcHeurSolveTrace.hpp"
+#include "GamsBonminRace.hpp"
 #include "GamsLinksConfig.h"
 
 #include "BonminConfig.h"
+#include "CbcConfig.h"
 #include "BonBonminSetup.hpp"
 #include "BonCbc.hpp"
 
@@ -38,6 +50,75 @@
 using namespace Bonmin;
 using namespace Ipopt;
 
+/** a run of Bonmin in a race of algorithms */
+struct BonminRacer
+{
+   std::string           algorithm;          /**< algorithm of run */
+   BonminSetup*          setup;              /**< Bonmin setup of run */
+   bool                  ownsetup;           /**< whether setup has been created for this run */
+   SmartPtr<GamsMINLP>   minlp;              /**< MINLP of run */
+   CoinMessageHandler*   msghandler;         /**< message handler of run, if created for this run */
+   Bab                   bb;                 /**< branch-and-bound of run */
+   double                time;               /**< time it took the run to finish */
+   bool                  winner;             /**< whether this run finished first with a proven result */
+   std::exception_ptr    error;              /**< exception that stopped the run, if any */
+
+   BonminRacer()
+   : setup(NULL),
+     ownsetup(false),
+     msghandler(NULL),
+     time(0.0),
+     winner(false)
+   { }
+
+   ~BonminRacer()
+   {
+      if( ownsetup )
+         delete setup;
+      delete msghandler;
+   }
+};
+
+/** sets up a run for a race of algorithms with options and a copy of the MINLP from the main run */
+static
+bool setupRacer(
+   BonminRacer&       racer,              /**< run to set up */
+   BonminSetup&       mainsetup,          /**< Bonmin setup of main run */
+   GamsMINLP&         mainminlp,          /**< MINLP of main run */
+   CoinMessageHandler& mainhandler,       /**< message handler of main run */
+   std::shared_ptr<GamsNLPCache> nlpcache /**< NLP cache to share, or empty */
+)
+{
+   SmartPtr<OptionsList> options = new OptionsList(*mainsetup.options());
+   if( !options->SetStringValue("bonmin.algorithm", racer.algorithm, true, true) )
+      return false;
+
+   // only the main run reports its progress
+   options->SetIntegerValue("bonmin.bb_log_level", 0, true, true);
+   options->SetIntegerValue("bonmin.lp_log_level", 0, true, true);
+   options->SetIntegerValue("bonmin.milp_log_level", 0, true, true);
+   options->SetIntegerValue("bonmin.nlp_log_level", 0, true, true);
+   options->SetIntegerValue("bonmin.oa_log_level", 0, true, true);
+   options->SetIntegerValue("bonmin.fp_log_level", 0, true, true);
+
+   racer.msghandler = mainhandler.clone();
+   racer.setup = new BonminSetup(racer.msghandler);
+   racer.ownsetup = true;
+   racer.setup->setOptionsAndJournalist(mainsetup.roptions(), options, mainsetup.journalist());
+
+   racer.minlp = new GamsMINLP(mainminlp);
+
+   OsiTMINLPInterface first_osi_tminlp;
+   first_osi_tminlp.passInMessageHandler(racer.msghandler);
+   first_osi_tminlp.initialize(mainsetup.roptions(), options, mainsetup.journalist(), GetRawPtr(racer.minlp));
+   IpoptSolver* ipoptsolver = dynamic_cast<IpoptSolver*>(GetRawPtr(first_osi_tminlp.solver()));
+   if( nlpcache && ipoptsolver != NULL )
+      first_osi_tminlp.setSolver(new GamsNLPCacheSolver(*ipoptsolver, nlpcache));
+   racer.setup->initialize(first_osi_tminlp);
+
+   return true;
+}
+
 GamsBonmin::~GamsBonmin()
 {
    delete bonmin_setup;
@@ -101,11 +182,15 @@ int GamsBonmin::readyAPI(
    delete bonmin_setup;
    bonmin_setup = new BonminSetup();
 
+   // message handler and journal share a mutex, as runs that race each other print from several threads
+   delete msghandler;
+   msghandler = new GamsMessageHandler(gev);
+
    // instead of initializeOptionsAndJournalist we do it our own way, so we can use a GamsJournal
    SmartPtr<OptionsList> options = new OptionsList();
    SmartPtr<Journalist> journalist= new Journalist();
    SmartPtr<Bonmin::RegisteredOptions> roptions = new Bonmin::RegisteredOptions();
-   SmartPtr<Journal> jrnl = new GamsJournal(gev, "console", J_ITERSUMMARY, J_STRONGWARNING);
+   SmartPtr<Journal> jrnl = new GamsJournal(gev, "console", J_ITERSUMMARY, J_STRONGWARNING, msghandler->getMutex());
    jrnl->SetPrintLevel(J_DBG, J_NONE);
    if( !journalist->AddJournal(jrnl) )
       gevLogStat(gev, "Failed to register GamsJournal for IPOPT output.");
@@ -134,12 +219,37 @@ int GamsBonmin::readyAPI(
       "yes",
       "no", "", "yes", "");
 
+   bonmin_setup->roptions()->SetRegisteringCategory("Linear Solver", Bonmin::RegisteredOptions::IpoptCategory);
+   bonmin_setup->roptions()->AddStringOption2("linear_solver_selection",
+      "Method to choose the linear solver.",
+      "fixed",
+      "fixed", "use linear solver as specified by option linear_solver",
+      "auto", "choose linear solver and ordering from size and density of the KKT system and the number of threads",
+      "With setting auto, the value of option linear_solver is overwritten. "
+      "The HSL solvers are considered only for BonminH.");
+
    bonmin_setup->roptions()->SetRegisteringCategory("NLP interface", Bonmin::RegisteredOptions::BonminCategory);
    bonmin_setup->roptions()->AddStringOption2("solvefinal",
       "Switch to disable solving MINLP with discrete variables fixed to solution values after solve.",
       "yes",
       "no", "", "yes", "",
       "If enabled, then the dual values from the resolved NLP are made available in GAMS.");
+   bonmin_setup->roptions()->AddLowerBoundedIntegerOption("nlp_cache_size",
+      "Maximal number of NLP results to keep for reuse",
+      0, 100,
+      "If an NLP with the same variable and constraint bounds as a cached one is to be solved, then its result is taken from the cache. "
+      "If only the bounds on discrete variables coincide, then the cached solution is used as starting point. "
+      "Applies only if Ipopt is used as NLP solver and NLPs are not resolved from random starting points (num_resolve_at_root, num_resolve_at_node, num_resolve_at_infeasibles). "
+      "A value of 0 disables the cache.");
+
+   bonmin_setup->roptions()->SetRegisteringCategory("Options for MILP solver", Bonmin::RegisteredOptions::BonminCategory);
+   bonmin_setup->roptions()->AddStringOption2("milp_solver_quadratic",
+      "Whether to pass quadratic functions to the MILP solver instead of linearizing them",
+      "yes",
+      "no", "", "yes", "",
+      "Applies if milp_solver is Cplex, the algorithm is not B-BB, the objective is at most quadratic, and all nonlinear constraints are quadratic inequalities. "
+      "Then the master problem of the outer approximation with the quadratic functions kept is the MIQCP itself, which Cplex solves directly. "
+      "If Cplex fails, e.g., because a quadratic function is not convex, then Bonmin runs as usual.");
 
    bonmin_setup->roptions()->SetRegisteringCategory("Branch-and-bound options", Bonmin::RegisteredOptions::BonminCategory);
    bonmin_setup->roptions()->AddStringOption2("clocktype",
@@ -147,10 +257,206 @@ int GamsBonmin::readyAPI(
       "wall",
       "cpu", "CPU time", "wall", "Wall-clock time",
       "");
+   bonmin_setup->roptions()->AddLowerBoundedIntegerOption("threads",
+      "Number of threads for parallel branch-and-bound",
+      0, 1,
+      "By default, branch-and-bound runs in a single thread. "
+      "If 0, the value of the GAMS threads option is used. "
+      "With more than one thread, nodes are processed in parallel, the NLP solver in each thread uses a single-threaded linear solver, "
+      "and equations are evaluated without going through GAMS where possible. "
+      "Requires that Cbc has been built with thread support.");
+   bonmin_setup->roptions()->AddStringOption1("race_algorithms",
+      "Algorithms to run in parallel, the first one to finish with a proven result determines the outcome",
+      "", "*",
+      "Space-separated list of algorithms (B-BB, B-OA, B-QG, B-Hyb, B-Ecp, B-iFP). "
+      "Each algorithm runs in its own thread on its own copy of the MINLP. Only the first algorithm prints its progress. "
+      "The runs share the objective value of the best solution found as cutoff. "
+      "If the list has less than two entries, then option algorithm is used.");
+   bonmin_setup->roptions()->AddStringOption1("oa_points_file",
+      "Name of file for storing linearization points for outer approximation cuts across solves",
+      "", "*",
+      "If the file exists and has been written for a MINLP with the same structure of nonlinear constraints, "
+      "then outer approximation cuts for nonlinear inequalities at the points from the file are added to the initial MILP relaxation. "
+      "At the end of the solve, the points of NLPs that have been solved to optimality are written to the file, "
+      "which requires that nlp_cache_size is positive. "
+      "Cuts are computed from the current data, but are valid only for convex (=L=) or concave (=G=) constraint functions.");
 
    return 0;
 }
 
+void GamsBonmin::storeSolution(
+   BonminSetup&       setup,              /**< Bonmin setup whose NLP solver resolves the NLP with fixed discrete variables */
+   GamsMINLP&         minlp,              /**< MINLP */
+   GamsNLPCache*      nlpcache,           /**< NLP cache to disable for the final NLP, or NULL */
+   const double*      solution,           /**< best solution, or NULL */
+   double             objval,             /**< objective value of best solution */
+   double             bestbound           /**< best bound */
+)
+{
+   // store primal solution in gmo
+   if( solution != NULL )
+   {
+      char buf[100];
+      snprintf(buf, 100, "\nBonmin finished. Found feasible solution. Objective function value = %g.", objval);
+      gevLogStat(gev, buf);
+
+#if GMOAPIVERSION < 12
+      double* lambda = new double[gmoM(gmo)];
+      for( int i = 0; i < gmoM(gmo); ++i )
+         lambda[i] = gmoValNA(gmo);
+
+      /* this also sets the gmoHobjval attribute to the level value of GAMS' objective variable */
+      gmoSetSolution2(gmo, solution, lambda);
+
+      delete[] lambda;
+#else
+      gmoSetSolutionPrimal(gmo, solution);
+#endif
+   }
+   else
+   {
+      gevLogStat(gev, "\nBonmin finished. No feasible solution found.");
+   }
+
+   // resolve MINLP with discrete variables fixed
+   bool solvefinal;
+   setup.options()->GetBoolValue("solvefinal", solvefinal, "bonmin.");
+   if( solvefinal && solution != NULL && gmoNDisc(gmo) < gmoN(gmo) )
+   {
+      gevLog(gev, "Resolve with fixed discrete variables to get dual values.");
+
+      OsiTMINLPInterface& osi_tminlp(*setup.nonlinearSolver());
+      for( Index i = 0; i < gmoN(gmo); ++i )
+         if( gmoGetVarTypeOne(gmo, i) != gmovar_X )
+            osi_tminlp.setColBounds(i, solution[i], solution[i]);
+      osi_tminlp.setColSolution(solution);
+
+      bool error_in_fixedsolve = false;
+      try
+      {
+         setup.options()->SetStringValue("print_user_options", "no", true, true);
+         // let Ipopt handle fixed variables as constraints, so we get dual values for it, which seems to be expected by GAMS
+         setup.options()->SetStringValue("fixed_variable_treatment", "make_constraint", true, true);
+         // since we changed fixed_variable_treatment, the NLP solved within Ipopt takes a different structure
+         // calling disableWarmStart() ensures that IpoptSolver::OptimizeTNLP does not tries to ReOptimize the TNLP
+         osi_tminlp.solver()->disableWarmStart();
+         // the NLP differs from the cached ones by the treatment of fixed variables
+         if( nlpcache )
+            nlpcache->setEnabled(false);
+         osi_tminlp.initialSolve();
+         error_in_fixedsolve = !osi_tminlp.isProvenOptimal();
+      }
+      catch( TNLPSolver::UnsolvedError* E)
+      {
+         // there has been a failure to solve a problem with Ipopt
+         char buf[1024];
+         snprintf(buf, 1024, "Error: %s exited with error %s", E->solverName().c_str(), E->errorName().c_str());
+         gevLogStat(gev, buf);
+         error_in_fixedsolve = true;
+      }
+      if( !error_in_fixedsolve && fabs(gmoGetHeadnTail(gmo, gmoHobjval) - minlp.isMin*osi_tminlp.getObjValue()) > 1e-4 )
+      {
+         gevLog(gev, "Warning: Optimal value of NLP subproblem differ from best MINLP value reported by Bonmin.\n"
+            "Will not replace solution, dual values will not be available.\n");
+      }
+      else if( !error_in_fixedsolve )
+      {
+         int n = gmoN(gmo);
+         int m = gmoM(gmo);
+
+         const double* z_L    = osi_tminlp.getRowPrice();
+         const double* z_U    = z_L+n;
+         const double* lambda = z_U+n;
+
+         double* colMarg    = new double[n];
+         for( Index i = 0; i < n; ++i )
+         {
+            // if, e.g., x_i has no lower bound, then the dual z_L[i] is -infinity
+            colMarg[i] = 0;
+            if( z_L[i] > gmoMinf(gmo) )
+               colMarg[i] += minlp.isMin * z_L[i];
+            if( z_U[i] < gmoPinf(gmo) )
+               colMarg[i] -= minlp.isMin * z_U[i];
+         }
+
+         double* negLambda = NULL;
+         if( minlp.isMin == 1.0 )
+         {
+            negLambda = new double[m];
+            for( Index i = 0;  i < m;  i++ )
+               negLambda[i] = -lambda[i];
+         }
+
+         /* this also sets the gmoHobjval attribute to the level value of GAMS' objective variable */
+         gmoSetSolution(gmo, osi_tminlp.getColSolution(), colMarg, negLambda != NULL ? negLambda : lambda, osi_tminlp.getRowActivity());
+
+         delete[] colMarg;
+         delete[] negLambda;
+      }
+      else
+      {
+         gevLogStat(gev, "Problems solving fixed problem. Dual variables for NLP subproblem not available.");
+      }
+   }
+
+   // print solving outcome (primal/dual bounds, gap)
+   gevLogStat(gev, "");
+   char buf[1024];
+   double best_val = gmoGetHeadnTail(gmo, gmoHobjval);
+   if( solution != NULL )
+   {
+      snprintf(buf, 1024, "Best solution: %15.6e   (%d nodes, %g seconds)\n", best_val, (int)gmoGetHeadnTail(gmo, gmoTmipnod), gmoGetHeadnTail(gmo, gmoHresused));
+      gevLogStat(gev, buf);
+   }
+   if( bestbound > -1e200 && bestbound < 1e200 )
+   {
+      snprintf(buf, 1024, "Best possible: %15.6e   (only reliable for convex models)", bestbound);
+      gevLogStat(gev, buf);
+
+      if( solution != NULL )
+      {
+         double optca;
+         double optcr;
+         setup.options()->GetNumericValue("allowable_gap", optca, "bonmin.");
+         setup.options()->GetNumericValue("allowable_fraction_gap", optcr, "bonmin.");
+
+         snprintf(buf, 255, "Absolute gap: %16.6e   (absolute tolerance optca: %g)", gmoGetAbsoluteGap(gmo), optca);
+         gevLogStat(gev, buf);
+         snprintf(buf, 255, "Relative gap: %16.6e   (relative tolerance optcr: %g)", gmoGetRelativeGap(gmo), optcr);
+         gevLogStat(gev, buf);
+      }
+   }
+}
+
+void GamsBonmin::storeOAPoints(
+   const char*        filename,           /**< name of file to write */
+   GamsNLPCache*      nlpcache,           /**< NLP cache to take solutions from, or NULL */
+   const double*      solution            /**< best solution, or NULL */
+)
+{
+   GamsOAPointStore oapoints;
+   if( nlpcache != NULL )
+   {
+      std::vector<std::vector<double> > xs;
+      std::vector<double> solvetimes;
+      nlpcache->getSolutions(xs, solvetimes);
+      for( size_t i = 0; i < xs.size(); ++i )
+         oapoints.add(xs[i].data(), gmoN(gmo), solvetimes[i]);
+   }
+   if( solution != NULL )
+      oapoints.add(solution, gmoN(gmo), 0.0);
+
+   if( oapoints.getNPoints() == 0 )
+      return;
+
+   char buf[GMS_SSSIZE+100];
+   if( oapoints.write(gmo, filename) )
+      snprintf(buf, sizeof(buf), "Stored %d outer approximation points in %s.", oapoints.getNPoints(), filename);
+   else
+      snprintf(buf, sizeof(buf), "Failed to write outer approximation points to %s.", filename);
+   gevLog(gev, buf);
+}
+
 int GamsBonmin::callSolver()
 {
    assert(gmo != NULL);
@@ -278,6 +584,58 @@ int GamsBonmin::callSolver()
    SmartPtr<GamsMINLP> minlp = new GamsMINLP(gmo);
    bonmin_setup->options()->GetNumericValue("diverging_iterates_tol", minlp->div_iter_tol, "");
 
+   // parallel branch-and-bound: threads evaluate in their own context and share the CPUs among each other
+   int bbthreads;
+   bonmin_setup->options()->GetIntegerValue("threads", bbthreads, "bonmin.");
+   if( bbthreads == 0 )
+      bbthreads = gevThreads(gev);
+#ifndef CBC_THREAD
+   if( bbthreads > 1 )
+   {
+      gevLogStat(gev, "Cbc has been built without thread support. Option threads ignored.");
+      bbthreads = 1;
+   }
+#endif
+   int nlpthreads = gevThreads(gev);
+   if( bbthreads > 1 )
+   {
+      minlp->paralleleval = true;
+      minlp->nlpthreads = 1;
+      nlpthreads = 1;
+   }
+
+   // algorithms to race against each other
+   std::vector<std::string> racealgos;
+   {
+      std::string racelist;
+      bonmin_setup->options()->GetStringValue("race_algorithms", racelist, "bonmin.");
+      std::istringstream racestream(racelist);
+      std::string algo;
+      while( racestream >> algo )
+         racealgos.push_back(algo);
+   }
+   if( racealgos.size() > 1 )
+   {
+      if( !bonmin_setup->options()->SetStringValue("bonmin.algorithm", racealgos[0], true, true) )
+      {
+         gevLogStat(gev, "Error: Unknown algorithm in option race_algorithms.");
+         gmoSolveStatSet(gmo, gmoSolveStat_SetupErr);
+         gmoModelStatSet(gmo, gmoModelStat_NoSolutionReturned);
+         return 0;
+      }
+      // runs are single-threaded and share the CPUs among each other
+      // messages from the MINLP of each run are synchronized with the other output
+      minlp->logmutex = msghandler->getMutex();
+      minlp->paralleleval = true;
+      minlp->nlpthreads = 1;
+      nlpthreads = 1;
+      bbthreads = 1;
+   }
+   else
+   {
+      racealgos.clear();
+   }
+
    if( minlp->have_negative_sos() )
    {
       gevLogStat(gev, "Error: Bonmin requires all variables in SOS to be non-negative.");
@@ -320,8 +678,17 @@ int GamsBonmin::callSolver()
    bonmin_setup->options()->GetBoolValue("print_eval_error", printevalerror, "");
    gmoEvalErrorMsg(gmo, printevalerror);
 
+   // choose linear solver for Ipopt, if requested
+   bonmin_setup->options()->GetStringValue("linear_solver_selection", parvalue, "");
+   if( parvalue == "auto" )
+   {
+      std::string msg = GAMSselectLinearSolver(*bonmin_setup->options(), *bonmin_setup->roptions(), ipoptlicensed,
+         gmoN(gmo), gmoM(gmo), gmoNZ64(gmo), hessian_is_approx ? 0 : gmoHessLagNz(gmo), nlpthreads);
+      gevLog(gev, msg.c_str());
+   }
+
    // set number of threads in linear algebra in ipopt
-   GAMSsetNumThreads(gev, gevThreads(gev));
+   GAMSsetNumThreads(gev, nlpthreads);
 
    // initialize solvetrace, if activated
    GAMS_SOLVETRACE* solvetrace_ = NULL;
@@ -352,12 +719,11 @@ int GamsBonmin::callSolver()
       }
    }
 
-   if( msghandler == NULL )
-      msghandler = new GamsMessageHandler(gev);
-
    if( minlp->isMin == -1 )
       gevLog(gev, "Note: Maximization problem reformulated as minimization problem for Bonmin, objective values are negated in output.");
 
+   std::shared_ptr<GamsNLPCache> nlpcache;
+
    try
    {
       // initialize Bonmin for current MINLP and options
@@ -367,6 +733,34 @@ int GamsBonmin::callSolver()
          OsiTMINLPInterface first_osi_tminlp;
          first_osi_tminlp.passInMessageHandler(msghandler);
          first_osi_tminlp.initialize(bonmin_setup->roptions(), bonmin_setup->options(), bonmin_setup->journalist(), GetRawPtr(minlp));
+
+         // let the NLP solver reuse results of NLPs that are solved repeatedly
+         int nlpcachesize;
+         bonmin_setup->options()->GetIntegerValue("nlp_cache_size", nlpcachesize, "bonmin.");
+         IpoptSolver* ipoptsolver = dynamic_cast<IpoptSolver*>(GetRawPtr(first_osi_tminlp.solver()));
+         if( nlpcachesize > 0 )
+         {
+            // resolving an NLP from random starting points needs the NLP to be solved again, which the cache would prevent
+            int numresolveroot;
+            int numresolvenode;
+            int numresolveinfeas;
+            bonmin_setup->options()->GetIntegerValue("num_resolve_at_root", numresolveroot, "bonmin.");
+            bonmin_setup->options()->GetIntegerValue("num_resolve_at_node", numresolvenode, "bonmin.");
+            bonmin_setup->options()->GetIntegerValue("num_resolve_at_infeasibles", numresolveinfeas, "bonmin.");
+            if( numresolveroot > 0 || numresolvenode > 0 || numresolveinfeas > 0 )
+            {
+               gevLog(gev, "NLP cache disabled, since NLPs are resolved from random starting points.");
+               nlpcachesize = 0;
+            }
+         }
+         if( nlpcachesize > 0 && ipoptsolver != NULL )
+         {
+            std::vector<bool> isdiscrete(gmoN(gmo));
+            for( int i = 0; i < gmoN(gmo); ++i )
+               isdiscrete[i] = gmoGetVarTypeOne(gmo, i) != gmovar_X;
+            nlpcache = std::make_shared<GamsNLPCache>(nlpcachesize, isdiscrete);
+            first_osi_tminlp.setSolver(new GamsNLPCacheSolver(*ipoptsolver, nlpcache));
+         }
          // double* sol = new double[gmoN(gmo)];
          // gmoGetVarL(gmo, sol);
          // first_osi_tminlp.activateRowCutDebugger(sol);
@@ -377,166 +771,263 @@ int GamsBonmin::callSolver()
             GAMSsolvetraceSetInfinity(solvetrace_, first_osi_tminlp.getInfinity());
       }
 
-      // try solving
-      Bab bb;
-
-      minlp->clockStart = gevTimeDiffStart(gev);
-      if( solvetrace_ != NULL )
-         GAMSsolvetraceResetStarttime(solvetrace_);
-
-      // change to wall-clock time if not requested otherwise
-      std::string clocktype;
-      bonmin_setup->options()->GetStringValue("clocktype", clocktype, "");
-      if( clocktype == "wall" )
-         bb.model().setUseElapsedTime(true);
-
-      bb(*bonmin_setup);
-
-      /* store solve statistics */
-      gmoSetHeadnTail(gmo, gmoHresused,  gevTimeDiffStart(gev) - minlp->clockStart);
-      gmoSetHeadnTail(gmo, gmoTmipnod,   bb.numNodes());
-      gmoSetHeadnTail(gmo, gmoHiterused, bb.iterationCount());
-      gmoSetHeadnTail(gmo, gmoHdomused,  static_cast<double>(minlp->domviolations));
-      double best_bound = minlp->isMin * bb.model().getBestPossibleObjValue(); //bestBound();
-      if( best_bound > -1e200 && best_bound < 1e200 )
-         gmoSetHeadnTail(gmo, gmoTmipbest, best_bound);
-      gmoModelStatSet(gmo, minlp->model_status);
-      gmoSolveStatSet(gmo, minlp->solver_status);
-
-      if( solvetrace_ != NULL )
-         GAMSsolvetraceAddEndLine(solvetrace_, bb.numNodes(), best_bound,
-            bb.bestSolution() != NULL ? minlp->isMin * bb.bestObj() : minlp->isMin * bb.model().getInfinity());
+      // file to read and store points for outer approximation cuts
+      std::string oapointsfile;
+      bonmin_setup->options()->GetStringValue("oa_points_file", oapointsfile, "bonmin.");
 
-      // store primal solution in gmo
-      if( bb.bestSolution() != NULL )
+#ifdef GAMSLINKS_HAS_CPLEX
+      // solve MIQCP with quadratic functions passed to Cplex, so no linearizations are needed
+      bool miqcpnative;
+      bonmin_setup->options()->GetBoolValue("milp_solver_quadratic", miqcpnative, "bonmin.");
+      bonmin_setup->options()->GetStringValue("milp_solver", parvalue, "bonmin.");
+      if( miqcpnative && parvalue == "Cplex" && bonmin_setup->getAlgorithm() != B_BB && racealgos.empty() && GamsMIQCPSolver::isMIQCP(gmo) )
       {
-         char buf[100];
-         snprintf(buf, 100, "\nBonmin finished. Found feasible solution. Objective function value = %g.", minlp->isMin * bb.bestObj());
-         gevLogStat(gev, buf);
+         gevLog(gev, "Passing MIQCP to Cplex with quadratic functions kept.");
+
+         double timelimit;
+         int nodelimit;
+         double optca;
+         double optcr;
+         bonmin_setup->options()->GetNumericValue("time_limit", timelimit, "bonmin.");
+         bonmin_setup->options()->GetIntegerValue("node_limit", nodelimit, "bonmin.");
+         bonmin_setup->options()->GetNumericValue("allowable_gap", optca, "bonmin.");
+         bonmin_setup->options()->GetNumericValue("allowable_fraction_gap", optcr, "bonmin.");
+
+         minlp->clockStart = gevTimeDiffStart(gev);
+         GamsMIQCPSolver miqcp(gmo, gev);
+         if( miqcp.solve(timelimit, nodelimit, optca, optcr, gevThreads(gev)) )
+         {
+            gmoSetHeadnTail(gmo, gmoHresused,  gevTimeDiffStart(gev) - minlp->clockStart);
+            gmoSetHeadnTail(gmo, gmoTmipnod,   (double)miqcp.nnodes);
+            gmoSetHeadnTail(gmo, gmoHiterused, (double)miqcp.niterations);
+            if( miqcp.bestbound > -1e200 && miqcp.bestbound < 1e200 )
+               gmoSetHeadnTail(gmo, gmoTmipbest, miqcp.bestbound);
+            gmoModelStatSet(gmo, miqcp.model_status);
+            gmoSolveStatSet(gmo, miqcp.solver_status);
+
+            if( solvetrace_ != NULL )
+            {
+               GAMSsolvetraceAddEndLine(solvetrace_, miqcp.nnodes, miqcp.bestbound,
+                  miqcp.x.empty() ? minlp->isMin * bonmin_setup->nonlinearSolver()->getInfinity() : miqcp.objval);
+               GAMSsolvetraceFree(&solvetrace_);
+            }
 
-#if GMOAPIVERSION < 12
-         double* lambda = new double[gmoM(gmo)];
-         for( int i = 0; i < gmoM(gmo); ++i )
-            lambda[i] = gmoValNA(gmo);
+            storeSolution(*bonmin_setup, *minlp, nlpcache.get(), miqcp.x.empty() ? NULL : miqcp.x.data(), miqcp.objval, miqcp.bestbound);
 
-         /* this also sets the gmoHobjval attribute to the level value of GAMS' objective variable */
-         gmoSetSolution2(gmo, bb.bestSolution(), lambda);
+            if( oapointsfile != "" )
+               storeOAPoints(oapointsfile.c_str(), nlpcache.get(), miqcp.x.empty() ? NULL : miqcp.x.data());
 
-         delete[] lambda;
-#else
-         gmoSetSolutionPrimal(gmo, bb.bestSolution());
-#endif
+            return 0;
+         }
+
+         gevLog(gev, "Cplex could not solve the MIQCP, continuing with Bonmin.");
       }
-      else
+#endif
+
+      // setup runs: the main one and, if racing algorithms, one for each further algorithm
+      std::list<BonminRacer> racers;
+      racers.emplace_back();
+      racers.back().setup = bonmin_setup;
+      racers.back().minlp = minlp;
+      if( !racealgos.empty() )
+         racers.back().algorithm = racealgos[0];
+      for( size_t i = 1; i < racealgos.size(); ++i )
       {
-         gevLogStat(gev, "\nBonmin finished. No feasible solution found.");
+         racers.emplace_back();
+         racers.back().algorithm = racealgos[i];
+         if( !setupRacer(racers.back(), *bonmin_setup, *minlp, *msghandler, nlpcache) )
+         {
+            gevLogStat(gev, "Error: Unknown algorithm in option race_algorithms.");
+            gmoSolveStatSet(gmo, gmoSolveStat_SetupErr);
+            gmoModelStatSet(gmo, gmoModelStat_NoSolutionReturned);
+            return 0;
+         }
       }
 
-      // resolve MINLP with discrete variables fixed
-      bool solvefinal;
-      bonmin_setup->options()->GetBoolValue("solvefinal", solvefinal, "bonmin.");
-      if( solvefinal && bb.bestSolution() != NULL && gmoNDisc(gmo) < gmoN(gmo) )
+      std::shared_ptr<GamsBonminRaceControl> racecontrol;
+      if( racers.size() > 1 )
       {
-         gevLog(gev, "Resolve with fixed discrete variables to get dual values.");
-
-         OsiTMINLPInterface& osi_tminlp(*bonmin_setup->nonlinearSolver());
-         for( Index i = 0; i < gmoN(gmo); ++i )
-            if( gmoGetVarTypeOne(gmo, i) != gmovar_X )
-               osi_tminlp.setColBounds(i, bb.bestSolution()[i], bb.bestSolution()[i]);
-         osi_tminlp.setColSolution(bb.bestSolution());
-
-         bool error_in_fixedsolve = false;
-         try
+         racecontrol = std::make_shared<GamsBonminRaceControl>();
+         GamsCbcEventRace raceevent(racecontrol);
+         for( BonminRacer& racer : racers )
          {
-            bonmin_setup->options()->SetStringValue("print_user_options", "no", true, true);
-            // let Ipopt handle fixed variables as constraints, so we get dual values for it, which seems to be expected by GAMS
-            bonmin_setup->options()->SetStringValue("fixed_variable_treatment", "make_constraint", true, true);
-            // since we changed fixed_variable_treatment, the NLP solved within Ipopt takes a different structure
-            // calling disableWarmStart() ensures that IpoptSolver::OptimizeTNLP does not tries to ReOptimize the TNLP
-            osi_tminlp.solver()->disableWarmStart();
-            osi_tminlp.initialSolve();
-            error_in_fixedsolve = !osi_tminlp.isProvenOptimal();
+            racer.setup->heuristics().push_back(BabSetupBase::HeuristicMethod());
+            BabSetupBase::HeuristicMethod& heurmeth(racer.setup->heuristics().back());
+            heurmeth.heuristic = new GamsCbcHeurRace(racecontrol);
+            heurmeth.id = "Algorithm race cutoff exchange";
+
+            // once another run has finished, stop the tree search and let evaluations fail, so that a running NLP solve ends, too
+            racer.bb.model().passInEventHandler(&raceevent);
+            racer.minlp->interrupt = &racecontrol->stop;
          }
-         catch( TNLPSolver::UnsolvedError* E)
+      }
+
+      // add outer approximation cuts at points from a previous solve
+      if( oapointsfile != "" )
+      {
+         GamsOAPointStore oapoints;
+         if( oapoints.read(gmo, oapointsfile.c_str()) )
          {
-            // there has been a failure to solve a problem with Ipopt
-            char buf[1024];
-            snprintf(buf, 1024, "Error: %s exited with error %s", E->solverName().c_str(), E->errorName().c_str());
-            gevLogStat(gev, buf);
-            error_in_fixedsolve = true;
+            double starttime = gevTimeDiffStart(gev);
+            OsiCuts cuts;
+            int ncuts = oapoints.generateCuts(gmo, *minlp, cuts);
+
+            char buffer[GMS_SSSIZE+255];
+            snprintf(buffer, sizeof(buffer), "Imported %d outer approximation cuts at %d points from %s in %.2f seconds, solving the NLPs for these points took %.2f seconds.",
+               ncuts, oapoints.getNPoints(), oapointsfile.c_str(), gevTimeDiffStart(gev) - starttime, oapoints.getSolveTime());
+            gevLog(gev, buffer);
+
+            if( ncuts > 0 )
+               for( BonminRacer& racer : racers )
+               {
+                  // B-BB does not use a MILP relaxation
+                  if( racer.setup->getAlgorithm() == B_BB )
+                     continue;
+                  // add cuts to the initial relaxation, from which branch-and-bound starts and the outer approximation builds its master problem
+                  racer.setup->continuousSolver()->applyCuts(cuts);
+               }
          }
-         if( !error_in_fixedsolve && fabs(gmoGetHeadnTail(gmo, gmoHobjval) - minlp->isMin*osi_tminlp.getObjValue()) > 1e-4 )
+         else
          {
-            gevLog(gev, "Warning: Optimal value of NLP subproblem differ from best MINLP value reported by Bonmin.\n"
-               "Will not replace solution, dual values will not be available.\n");
+            gevLog(gev, "No outer approximation points for this model structure found in oa_points_file.");
          }
-         else if( !error_in_fixedsolve )
-         {
-            int n = gmoN(gmo);
-            int m = gmoM(gmo);
+      }
 
-            const double* z_L    = osi_tminlp.getRowPrice();
-            const double* z_U    = z_L+n;
-            const double* lambda = z_U+n;
+      // try solving
+      std::string clocktype;
+      bonmin_setup->options()->GetStringValue("clocktype", clocktype, "");
 
-            double* colMarg    = new double[n];
-            for( Index i = 0; i < n; ++i )
-            {
-               // if, e.g., x_i has no lower bound, then the dual z_L[i] is -infinity
-               colMarg[i] = 0;
-               if( z_L[i] > gmoMinf(gmo) )
-                  colMarg[i] += minlp->isMin * z_L[i];
-               if( z_U[i] < gmoPinf(gmo) )
-                  colMarg[i] -= minlp->isMin * z_U[i];
-            }
+      for( BonminRacer& racer : racers )
+      {
+         // change to wall-clock time if not requested otherwise
+         if( clocktype == "wall" )
+            racer.bb.model().setUseElapsedTime(true);
+         racer.minlp->clockStart = gevTimeDiffStart(gev);
+      }
+      if( solvetrace_ != NULL )
+         GAMSsolvetraceResetStarttime(solvetrace_);
 
-            double* negLambda = NULL;
-            if( minlp->isMin == 1.0 )
-            {
-               negLambda = new double[m];
-               for( Index i = 0;  i < m;  i++ )
-                  negLambda[i] = -lambda[i];
-            }
+      if( bbthreads > 1 )
+      {
+         char buffer[100];
+         sprintf(buffer, "Running branch-and-bound with %d threads.\n", bbthreads);
+         gevLogPChar(gev, buffer);
+#ifdef CBC_THREAD
+         racers.front().bb.model().setNumberThreads(bbthreads);
+#endif
+      }
 
-            /* this also sets the gmoHobjval attribute to the level value of GAMS' objective variable */
-            gmoSetSolution(gmo, osi_tminlp.getColSolution(), colMarg, negLambda != NULL ? negLambda : lambda, osi_tminlp.getRowActivity());
+      BonminRacer* winner = &racers.front();
+      if( racers.size() == 1 )
+      {
+         winner->bb(*bonmin_setup);
+      }
+      else
+      {
+         char buffer[255];
+         sprintf(buffer, "Racing %d algorithms, showing progress of %s.\n", (int)racers.size(), racers.front().algorithm.c_str());
+         gevLogPChar(gev, buffer);
 
-            delete[] colMarg;
-            delete[] negLambda;
-         }
-         else
+         std::vector<std::thread> threads;
+         for( BonminRacer& racer : racers )
+            threads.emplace_back([&racer, &racecontrol, this]()
+            {
+               try
+               {
+                  racer.bb(*racer.setup);
+               }
+               catch( ... )
+               {
+                  // a run that has been stopped may end with an error from the interrupted NLP solve, which is of no interest
+                  if( !racecontrol->stop )
+                     racer.error = std::current_exception();
+               }
+               racer.time = gevTimeDiffStart(gev) - racer.minlp->clockStart;
+
+               // the first run with a proven result wins and stops the others
+               if( !racer.error &&
+                  (racer.bb.mipStatus() == Bab::FeasibleOptimal || racer.bb.mipStatus() == Bab::ProvenInfeasible || racer.bb.mipStatus() == Bab::UnboundedOrInfeasible) &&
+                  !racecontrol->stop.exchange(true) )
+                  racer.winner = true;
+            });
+         for( std::thread& thread : threads )
+            thread.join();
+
+         // evaluations for the final NLP need to succeed again
+         for( BonminRacer& racer : racers )
+            racer.minlp->interrupt = NULL;
+
+         // take result of winner, otherwise the run with the best solution, otherwise the first run that did not fail
+         winner = NULL;
+         for( BonminRacer& racer : racers )
+            if( racer.winner )
+               winner = &racer;
+         if( winner == NULL )
+            for( BonminRacer& racer : racers )
+               if( !racer.error && racer.bb.bestSolution() != NULL && (winner == NULL || racer.bb.bestObj() < winner->bb.bestObj()) )
+                  winner = &racer;
+         if( winner == NULL )
+            for( BonminRacer& racer : racers )
+               if( !racer.error )
+               {
+                  winner = &racer;
+                  break;
+               }
+         if( winner == NULL )
+            std::rethrow_exception(racers.front().error);
+
+         gevLog(gev, "");
+         for( BonminRacer& racer : racers )
          {
-            gevLogStat(gev, "Problems solving fixed problem. Dual variables for NLP subproblem not available.");
+            sprintf(buffer, "%-6s %-8s after %8.2f seconds, %8d nodes", racer.algorithm.c_str(),
+               racer.error ? "failed" : racer.winner ? "finished" : "stopped", racer.time, racer.bb.numNodes());
+            if( !racer.error && racer.bb.bestSolution() != NULL )
+               sprintf(buffer + strlen(buffer), ", best solution %g", minlp->isMin * racer.bb.bestObj());
+            gevLog(gev, buffer);
          }
+         if( winner->winner )
+            sprintf(buffer, "Algorithm race won by %s.", winner->algorithm.c_str());
+         else
+            sprintf(buffer, "No algorithm finished, taking result of %s.", winner->algorithm.c_str());
+         gevLog(gev, buffer);
+
+         // report domain violations of all runs, then continue with the result of the winner
+         long int domviolations = 0;
+         for( BonminRacer& racer : racers )
+            domviolations += racer.minlp->domviolations;
+         winner->minlp->domviolations = domviolations;
+         minlp = winner->minlp;
       }
+      Bab& bb(winner->bb);
 
-      // print solving outcome (primal/dual bounds, gap)
-      gevLogStat(gev, "");
-      char buf[1024];
-      double best_val = gmoGetHeadnTail(gmo, gmoHobjval);
-      if( bb.bestSolution() != NULL )
+      if( nlpcache && nlpcache->getNLookups() > 0 )
       {
-         snprintf(buf, 1024, "Best solution: %15.6e   (%d nodes, %g seconds)\n", best_val, (int)gmoGetHeadnTail(gmo, gmoTmipnod), gmoGetHeadnTail(gmo, gmoHresused));
-         gevLogStat(gev, buf);
+         char buffer[255];
+         sprintf(buffer, "NLP cache: %ld lookups, %ld hits (%.1f%%), %ld warm starts from NLPs with same integer fixings.\n",
+            nlpcache->getNLookups(), nlpcache->getNHits(), 100.0 * nlpcache->getNHits() / nlpcache->getNLookups(), nlpcache->getNWarmStarts());
+         gevLogPChar(gev, buffer);
       }
+
+      /* store solve statistics */
+      gmoSetHeadnTail(gmo, gmoHresused,  gevTimeDiffStart(gev) - minlp->clockStart);
+      gmoSetHeadnTail(gmo, gmoTmipnod,   bb.numNodes());
+      gmoSetHeadnTail(gmo, gmoHiterused, bb.iterationCount());
+      gmoSetHeadnTail(gmo, gmoHdomused,  static_cast<double>(minlp->domviolations));
+      double best_bound = minlp->isMin * bb.model().getBestPossibleObjValue(); //bestBound();
       if( best_bound > -1e200 && best_bound < 1e200 )
-      {
-         snprintf(buf, 1024, "Best possible: %15.6e   (only reliable for convex models)", best_bound);
-         gevLogStat(gev, buf);
+         gmoSetHeadnTail(gmo, gmoTmipbest, best_bound);
+      gmoModelStatSet(gmo, minlp->model_status);
+      gmoSolveStatSet(gmo, minlp->solver_status);
 
-         if( bb.bestSolution() != NULL )
-         {
-            double optca;
-            double optcr;
-            bonmin_setup->options()->GetNumericValue("allowable_gap", optca, "bonmin.");
-            bonmin_setup->options()->GetNumericValue("allowable_fraction_gap", optcr, "bonmin.");
-
-            snprintf(buf, 255, "Absolute gap: %16.6e   (absolute tolerance optca: %g)", gmoGetAbsoluteGap(gmo), optca);
-            gevLogStat(gev, buf);
-            snprintf(buf, 255, "Relative gap: %16.6e   (relative tolerance optcr: %g)", gmoGetRelativeGap(gmo), optcr);
-            gevLogStat(gev, buf);
-         }
-      }
+      if( solvetrace_ != NULL )
+         GAMSsolvetraceAddEndLine(solvetrace_, bb.numNodes(), best_bound,
+            bb.bestSolution() != NULL ? minlp->isMin * bb.bestObj() : minlp->isMin * bb.model().getInfinity());
+
+      storeSolution(*winner->setup, *minlp, nlpcache.get(), bb.bestSolution(), bb.bestSolution() != NULL ? minlp->isMin * bb.bestObj() : 0.0, best_bound);
+
+      // store linearization points for the next solve
+      if( oapointsfile != "" )
+         storeOAPoints(oapointsfile.c_str(), nlpcache.get(), bb.bestSolution());
    }
    catch( CoinError& error )
    {
@@ -14,6 +14,8 @@ typedef struct gevRec* gevHandle_t;
 typedef struct palRec* palHandle_t;
 
 class GamsMessageHandler;
+class GamsMINLP;
+class GamsNLPCache;
 namespace Bonmin
 {
 class BonminSetup;
@@ -31,6 +33,23 @@ private:
 	GamsMessageHandler*   msghandler;         /**< COIN-OR message handler for GAMS */
    bool                  ipoptlicensed;      /**< whether a commercial Ipopt license is available */
 
+   /** stores a solution in GMO, resolves the NLP with fixed discrete variables to get dual values, if enabled, and prints the solving outcome */
+   void storeSolution(
+      Bonmin::BonminSetup& setup,            /**< Bonmin setup whose NLP solver resolves the NLP with fixed discrete variables */
+      GamsMINLP&         minlp,              /**< MINLP */
+      GamsNLPCache*      nlpcache,           /**< NLP cache to disable for the final NLP, or NULL */
+      const double*      solution,           /**< best solution, or NULL */
+      double             objval,             /**< objective value of best solution */
+      double             bestbound           /**< best bound */
+   );
+
+   /** stores the solutions of cached NLPs and the best solution as points for outer approximation cuts in a file */
+   void storeOAPoints(
+      const char*        filename,           /**< name of file to write */
+      GamsNLPCache*      nlpcache,           /**< NLP cache to take solutions from, or NULL */
+      const double*      solution            /**< best solution, or NULL */
+   );
+
 public:
 	GamsBonmin()
 	: gmo(NULL),
@@ -0,0 +1,121 @@
+// Copyright (C) GAMS Development and others
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// Author: Stefan Vigerske
+
+#ifndef GAMSBONMINRACE_HPP_
+#define GAMSBONMINRACE_HPP_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "CbcEventHandler.hpp"
+#include "CbcHeuristic.hpp"
+#include "CbcModel.hpp"
+
+/** data shared by Bonmin runs that race against each other */
+class GamsBonminRaceControl
+{
+private:
+   std::mutex            mutex;              /**< protects cutoff */
+   double                cutoff;             /**< best objective value found by any run */
+
+public:
+   std::atomic<bool>     stop;               /**< whether runs should stop, checked by the Cbc event handler and by the evaluations of each run's GamsMINLP */
+
+   GamsBonminRaceControl()
+   : cutoff(COIN_DBL_MAX),
+     stop(false)
+   { }
+
+   /** reports an objective value of a solution found by one run */
+   void updateCutoff(
+      double             objval              /**< objective value */
+   )
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      if( objval < cutoff )
+         cutoff = objval;
+   }
+
+   /** gives the best objective value found by any run */
+   double getCutoff()
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      return cutoff;
+   }
+};
+
+/** CbcHeuristic that exchanges the cutoff with other racing runs */
+class GamsCbcHeurRace : public CbcHeuristic
+{
+private:
+   std::shared_ptr<GamsBonminRaceControl> control; /**< data shared by all runs */
+
+public:
+   GamsCbcHeurRace(
+      std::shared_ptr<GamsBonminRaceControl> control_ /**< data shared by all runs */
+   )
+   : control(control_)
+   { }
+
+   CbcHeuristic* clone() const
+   {
+      return new GamsCbcHeurRace(control);
+   }
+
+   void resetModel(
+      CbcModel*          model
+   )
+   { }
+
+   int solution(
+      double&            objectiveValue,
+      double*            newSolution
+   )
+   {
+      if( model_->getSolutionCount() > 0 )
+         control->updateCutoff(model_->getObjValue());
+
+      double cutoff = control->getCutoff();
+      if( cutoff < model_->getCutoff() )
+         model_->setCutoff(cutoff);
+
+      return 0;
+   }
+
+   using CbcHeuristic::solution;
+};
+
+/** CbcEventHandler that stops the branch-and-bound of a run when another run has finished */
+class GamsCbcEventRace : public CbcEventHandler
+{
+private:
+   std::shared_ptr<GamsBonminRaceControl> control; /**< data shared by all runs */
+
+public:
+   GamsCbcEventRace(
+      std::shared_ptr<GamsBonminRaceControl> control_ /**< data shared by all runs */
+   )
+   : control(control_)
+   { }
+
+   CbcEventHandler* clone() const
+   {
+      return new GamsCbcEventRace(control);
+   }
+
+   CbcAction event(
+      CbcEvent           whichEvent
+   )
+   {
+      if( control->stop && whichEvent != endSearch )
+         return stop;
+
+      return noAction;
+   }
+};
+
+#endif // GAMSBONMINRACE_HPP_
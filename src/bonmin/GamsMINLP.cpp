@@ -9,9 +9,11 @@
 #include "BonminConfig.h"
 
 #include <cstring> // for memcpy
+#include <cmath>
 
 #include "gmomcc.h"
 #include "gevmcc.h"
+#include "GamsHelper.h"
 
 using namespace Ipopt;
 using namespace Bonmin;
@@ -24,12 +26,16 @@ GamsMINLP::GamsMINLP(
   gev(gmo_ ? (gevRec*)gmoEnvironment(gmo_) : NULL),
   iRowStart(NULL),
   jCol(NULL),
-  grad(NULL),
+  gmostate(std::make_shared<GmoState>()),
+  nleval(NULL),
   in_couenne(in_couenne_),
   negativesos(false),
   domviolations(0),
   model_status(gmoModelStat_ErrorNoSolution),
-  solver_status(gmoSolveStat_SetupErr)
+  solver_status(gmoSolveStat_SetupErr),
+  paralleleval(false),
+  nlpthreads(0),
+  interrupt(NULL)
 {
    assert(gmo != NULL);
 
@@ -38,11 +44,49 @@ GamsMINLP::GamsMINLP(
    setupPrioritiesSOS();
 }
 
+GamsMINLP::GamsMINLP(
+   const GamsMINLP&   other               /**< MINLP to copy */
+)
+: Bonmin::TMINLP(),
+  gmo(other.gmo),
+  gev(other.gev),
+  isMin(other.isMin),
+  domviollimit(other.domviollimit),
+  iRowStart(NULL),
+  jCol(NULL),
+  gmostate(other.gmostate),
+  nleval(NULL),
+  in_couenne(other.in_couenne),
+  negativesos(false),
+  div_iter_tol(other.div_iter_tol),
+  clockStart(other.clockStart),
+  domviolations(0),
+  model_status(gmoModelStat_ErrorNoSolution),
+  solver_status(gmoSolveStat_SetupErr),
+  paralleleval(other.paralleleval),
+  nlpthreads(other.nlpthreads),
+  logmutex(other.logmutex),
+  interrupt(NULL)
+{
+   std::lock_guard<std::mutex> lock(gmostate->mutex);
+   setupPrioritiesSOS();
+}
+
 GamsMINLP::~GamsMINLP()
 {
    delete[] iRowStart;
    delete[] jCol;
-   delete[] grad;
+   delete nleval;
+}
+
+void GamsMINLP::logStat(
+   const char*        msg
+)
+{
+   std::unique_lock<std::mutex> lock;
+   if( logmutex )
+      lock = std::unique_lock<std::mutex>(*logmutex);
+   gevLogStatPChar(gev, msg);
 }
 
 void GamsMINLP::setupPrioritiesSOS()
@@ -132,6 +176,161 @@ void GamsMINLP::setupPrioritiesSOS()
    delete[] sostype;
 }
 
+GamsMINLP::EvalContext& GamsMINLP::getContext()
+{
+   std::lock_guard<std::mutex> lock(contextmutex);
+
+   std::map<std::thread::id, EvalContext>::iterator it = contexts.find(std::this_thread::get_id());
+   if( it != contexts.end() )
+      return it->second;
+
+   EvalContext& ctx = contexts[std::this_thread::get_id()];
+   ctx.grad.resize(gmoN(gmo));
+   ctx.newpoint = true;
+
+   // first evaluation in this thread, which is then likely a worker of the branch-and-bound
+   if( nlpthreads > 0 )
+      GAMSsetNumThreadsLocal(nlpthreads);
+
+   return ctx;
+}
+
+std::unique_lock<std::mutex> GamsMINLP::lockGmo(
+   EvalContext&       ctx,                /**< evaluation context of calling thread */
+   const Ipopt::Number* x                 /**< point of calling thread */
+)
+{
+   std::unique_lock<std::mutex> lock(gmostate->mutex);
+
+   if( ctx.newpoint || gmostate->point != &ctx )
+   {
+      gmoEvalNewPoint(gmo, x);
+      ctx.newpoint = false;
+      gmostate->point = &ctx;
+   }
+
+   return lock;
+}
+
+void GamsMINLP::setupJacobian()
+{
+   if( iRowStart != NULL )
+      return;
+
+   int m = gmoM(gmo);
+   int nz = gmoNZ(gmo);
+
+   iRowStart = new int[m+1];
+   jCol = new int[nz];
+   double* jacval = new double[nz];
+
+   gmoGetMatrixRow(gmo, iRowStart, jCol, jacval, NULL);
+   assert(iRowStart[m] == nz);
+
+   delete[] jacval;
+
+   if( !paralleleval || m == 0 )
+      return;
+
+   int* rows = new int[m];
+   for( int i = 0; i < m; ++i )
+      rows[i] = i;
+
+   nleval = new GamsNLEvaluator(gmo);
+   int ncompiled = nleval->compile(m, rows);
+
+   // check evaluator against GMO at starting point and at a nearby point
+   int nmismatch = 0;
+   if( ncompiled > 0 )
+   {
+      int n = gmoN(gmo);
+      double* x = new double[n];
+      gmoGetVarL(gmo, x);
+      nmismatch += nleval->verify(x, iRowStart, jCol);
+      for( int j = 0; j < n; ++j )
+         x[j] += 1e-3 * (1.0 + fabs(x[j]));
+      nmismatch += nleval->verify(x, iRowStart, jCol);
+      delete[] x;
+
+      // verification moved GMO to another point
+      gmostate->point = NULL;
+   }
+
+   char buffer[255];
+   sprintf(buffer, "Thread-safe evaluation: %d of %d equations compiled, %d unsupported, %d mismatching GMO.\n",
+      nleval->getNRows(), m, m - ncompiled, nmismatch);
+   gevLogPChar(gev, buffer);
+
+   delete[] rows;
+}
+
+bool GamsMINLP::evalGradRows(
+   EvalContext&       ctx,                /**< evaluation context of calling thread */
+   const Ipopt::Number* x,                /**< point */
+   int                nrows,              /**< number of rows */
+   const int*         rows,               /**< indices of rows, or NULL for rows 0..nrows-1 */
+   Ipopt::Number*     values,             /**< buffer for gradient values */
+   const char*        caller              /**< name of calling routine, for error messages */
+)
+{
+   if( nleval != NULL )
+      nleval->initWorkspace(ctx.ws);
+
+   // GMO is locked only when we meet the first row that the evaluator cannot handle
+   std::unique_lock<std::mutex> lock;
+
+   double* grad = ctx.grad.data();
+   double val;
+   double gx;
+   int nerror, rc;
+
+   for( int r = 0; r < nrows; ++r )
+   {
+      int row = rows != NULL ? rows[r] : r;
+      int len = iRowStart[row+1] - iRowStart[row];
+      const int* cols = jCol + iRowStart[row];
+
+      if( nleval != NULL && nleval->isCompiled(row) )
+      {
+         if( nleval->evalRowGrad(row, x, ctx.ws, val, len, cols, values) > 0 )
+         {
+            ++domviolations;
+            return false;
+         }
+         values += len;
+         continue;
+      }
+
+      if( !lock.owns_lock() )
+         lock = lockGmo(ctx, x);
+
+      rc = gmoEvalGrad(gmo, row, x, &val, grad, &gx, &nerror);
+      if( rc != 0 )
+      {
+         char buffer[255];
+         sprintf(buffer, "Critical error %d detected in evaluation of gradient of constraint %d!\n"
+            "Exiting from subroutine - %s\n", rc, row, caller);
+         logStat(buffer);
+         throw -1;
+      }
+      if( nerror > 0 )
+      {
+         ++domviolations;
+         return false;
+      }
+
+      // gather the entries of the row and clear them again, so the buffer is zero outside of a row evaluation
+      for( int k = 0; k < len; ++k )
+      {
+         values[k] = grad[cols[k]];
+         grad[cols[k]] = 0.0;
+      }
+      values += len;
+   }
+
+   return true;
+}
+
 bool GamsMINLP::get_nlp_info(
    Ipopt::Index&      n,
    Ipopt::Index&      m,
@@ -161,6 +360,8 @@ bool GamsMINLP::get_bounds_info(
    assert(n == gmoN(gmo));
    assert(m == gmoM(gmo));
 
+   std::lock_guard<std::mutex> lock(gmostate->mutex);
+
    gmoGetVarLower(gmo, x_l);
    gmoGetVarUpper(gmo, x_u);
    gmoGetRhs(gmo, g_u);
@@ -215,6 +416,8 @@ bool GamsMINLP::get_starting_point(
    assert(n == gmoN(gmo));
    assert(m == gmoM(gmo));
 
+   std::lock_guard<std::mutex> lock(gmostate->mutex);
+
    if( init_lambda )
    {
       gmoGetEquM(gmo, lambda);
@@ -248,14 +451,14 @@ bool GamsMINLP::get_starting_point(
          {
             char buffer[255];
             sprintf(buffer, "Initial value %e for variable %d below diverging iterates tolerance %e. Set initial value to %e.\n", x[j], j, -div_iter_tol, -0.99*div_iter_tol);
-            gevLogStatPChar(gev, buffer);
+            logStat(buffer);
             x[j] = -0.99*div_iter_tol;
          }
          else if( x[j] > div_iter_tol )
          {
             char buffer[255];
             sprintf(buffer, "Initial value %e for variable %d above diverging iterates tolerance %e. Set initial value to %e.\n", x[j], j, div_iter_tol, 0.99*div_iter_tol);
-            gevLogStatPChar(gev, buffer);
+            logStat(buffer);
             x[j] = 0.99*div_iter_tol;
          }
       }
@@ -368,8 +571,14 @@ bool GamsMINLP::eval_f(
 {
    assert(n == gmoN(gmo));
 
+   // run has been stopped, so let the NLP solver end
+   if( interrupt != NULL && *interrupt )
+      return false;
+
+   EvalContext& ctx = getContext();
    if( new_x )
-      gmoEvalNewPoint(gmo, x);
+      ctx.newpoint = true;
+   std::unique_lock<std::mutex> lock(lockGmo(ctx, x));
 
    int nerror;
    int rc;
@@ -380,7 +589,7 @@ bool GamsMINLP::eval_f(
       char buffer[255];
       sprintf(buffer, "Critical error %d detected in evaluation of objective function!\n"
          "Exiting from subroutine - eval_f\n", rc);
-      gevLogStatPChar(gev, buffer);
+      logStat(buffer);
       throw -1;
    }
    if( nerror > 0 )
@@ -402,8 +611,10 @@ bool GamsMINLP::eval_grad_f(
 {
    assert(n == gmoN(gmo));
 
+   EvalContext& ctx = getContext();
    if( new_x )
-      gmoEvalNewPoint(gmo, x);
+      ctx.newpoint = true;
+   std::unique_lock<std::mutex> lock(lockGmo(ctx, x));
 
    memset(grad_f, 0, n*sizeof(double));
    double val;
@@ -417,7 +628,7 @@ bool GamsMINLP::eval_grad_f(
       char buffer[255];
       sprintf(buffer, "Critical error %d detected in evaluation of objective gradient!\n"
          "Exiting from subroutine - eval_grad_f\n", rc);
-      gevLogStatPChar(gev, buffer);
+      logStat(buffer);
       throw -1;
    }
    if( nerror > 0 )
@@ -444,19 +655,42 @@ bool GamsMINLP::eval_g(
    assert(n == gmoN(gmo));
    assert(m == gmoM(gmo));
 
+   // run has been stopped, so let the NLP solver end
+   if( interrupt != NULL && *interrupt )
+      return false;
+
+   EvalContext& ctx = getContext();
    if( new_x )
-      gmoEvalNewPoint(gmo, x);
+      ctx.newpoint = true;
+   if( nleval != NULL )
+      nleval->initWorkspace(ctx.ws);
+
+   // GMO is locked only when we meet the first row that the evaluator cannot handle
+   std::unique_lock<std::mutex> lock;
 
    int nerror, rc;
    for( int i = 0; i < m; ++i )
    {
+      if( nleval != NULL && nleval->isCompiled(i) )
+      {
+         if( nleval->evalRow(i, x, ctx.ws, g[i]) > 0 )
+         {
+            ++domviolations;
+            return false;
+         }
+         continue;
+      }
+
+      if( !lock.owns_lock() )
+         lock = lockGmo(ctx, x);
+
       rc = gmoEvalFunc(gmo, i, x, &g[i], &nerror);
       if( rc != 0 )
       {
          char buffer[255];
          sprintf(buffer, "Critical error %d detected in evaluation of constraint %d!\n"
             "Exiting from subroutine - eval_g\n", rc, i);
-         gevLogStatPChar(gev, buffer);
+         logStat(buffer);
          throw -1;
       }
       if( nerror > 0 )
@@ -490,24 +724,15 @@ bool GamsMINLP::eval_jac_g(
       assert(NULL != iRow);
       assert(NULL != jCol);
 
-      delete[] iRowStart;
-      delete[] this->jCol;
-      iRowStart      = new int[m+1];
-      this->jCol     = new int[nele_jac];
-      double* jacval = new double[nele_jac];
-
-      gmoGetMatrixRow(gmo, iRowStart, this->jCol, jacval, NULL);
+      {
+         std::lock_guard<std::mutex> lock(gmostate->mutex);
+         setupJacobian();
+      }
 
-      assert(iRowStart[m] == nele_jac);
       for( Index i = 0; i < m; ++i )
          for( int j = iRowStart[i]; j < iRowStart[i+1]; ++j )
             iRow[j] = i;
       memcpy(jCol, this->jCol, nele_jac * sizeof(int));
-
-      delete[] jacval;
-
-      delete[] grad;
-      grad = new double[n];
    }
    else
    {
@@ -517,40 +742,12 @@ bool GamsMINLP::eval_jac_g(
       assert(NULL == jCol);
       assert(NULL != iRowStart);
       assert(NULL != this->jCol);
-      assert(NULL != grad);
 
+      EvalContext& ctx = getContext();
       if( new_x )
-         gmoEvalNewPoint(gmo, x);
+         ctx.newpoint = true;
 
-      double val;
-      double gx;
-      int nerror, rc;
-      int k;
-      int next;
-
-      k = 0;
-      for( int rownr = 0; rownr < m; ++rownr )
-      {
-         rc = gmoEvalGrad(gmo, rownr, x, &val, grad, &gx, &nerror);
-         if( rc != 0 )
-         {
-            char buffer[255];
-            sprintf(buffer, "Critical error %d detected in evaluation of gradient for constraint %d!\n"
-               "Exiting from subroutine - eval_jac_g\n", rc, rownr);
-            gevLogStatPChar(gev, buffer);
-            throw -1;
-         }
-         if( nerror > 0 )
-         {
-            ++domviolations;
-            return false;
-         }
-         assert(k == iRowStart[rownr]);
-         next = iRowStart[rownr+1];
-         for( ; k < next; ++k )
-            values[k] = grad[this->jCol[k]];
-      }
-      assert(k == nele_jac);
+      return evalGradRows(ctx, x, m, NULL, values, "eval_jac_g");
    }
 
    return true;
@@ -566,8 +763,22 @@ bool GamsMINLP::eval_gi(
 {
    assert(n == gmoN(gmo));
 
+   EvalContext& ctx = getContext();
    if( new_x )
-      gmoEvalNewPoint(gmo, x);
+      ctx.newpoint = true;
+
+   if( nleval != NULL && nleval->isCompiled(i) )
+   {
+      nleval->initWorkspace(ctx.ws);
+      if( nleval->evalRow(i, x, ctx.ws, gi) > 0 )
+      {
+         ++domviolations;
+         return false;
+      }
+      return true;
+   }
+
+   std::unique_lock<std::mutex> lock(lockGmo(ctx, x));
 
    int nerror;
    int rc = gmoEvalFunc(gmo, i, x, &gi, &nerror);
@@ -577,7 +788,7 @@ bool GamsMINLP::eval_gi(
       char buffer[255];
       sprintf(buffer, "Critical error %d detected in evaluation of constraint %d!\n"
          "Exiting from subroutine - eval_gi\n", rc, i);
-      gevLogStatPChar(gev, buffer);
+      logStat(buffer);
       throw -1;
    }
    if( nerror > 0 )
@@ -606,48 +817,73 @@ bool GamsMINLP::eval_grad_gi(
    {
       assert(NULL == x);
       assert(NULL != jCol);
-      assert(NULL != jCol);
-      assert(NULL != iRowStart);
 
-      nele_grad_gi = iRowStart[i+1] - iRowStart[i];
-      memcpy(jCol, jCol + iRowStart[i], nele_grad_gi * sizeof(int));
+      {
+         std::lock_guard<std::mutex> lock(gmostate->mutex);
+         setupJacobian();
+      }
 
+      nele_grad_gi = iRowStart[i+1] - iRowStart[i];
+      memcpy(jCol, this->jCol + iRowStart[i], nele_grad_gi * sizeof(int));
    }
    else
    {
       assert(NULL != x);
       assert(NULL == jCol);
-      assert(NULL != grad);
+      assert(NULL != iRowStart);
 
+      EvalContext& ctx = getContext();
       if( new_x )
-         gmoEvalNewPoint(gmo, x);
+         ctx.newpoint = true;
 
-      double val;
-      double gx;
+      return evalGradRows(ctx, x, 1, &i, values, "eval_grad_gi");
+   }
 
-      int nerror;
-      int rc = gmoEvalGrad(gmo, i, x, &val, grad, &gx, &nerror);
+   return true;
+}
 
-      if( rc != 0 )
-      {
-         char buffer[255];
-         sprintf(buffer, "Critical error %d detected in evaluation of gradient of constraint %d!\n"
-            "Exiting from subroutine - eval_grad_gi\n", rc, i);
-         gevLogStatPChar(gev, buffer);
-         throw -1;
-      }
-      if( nerror > 0 )
+bool GamsMINLP::eval_grad_gi_batch(
+   Ipopt::Index       n,
+   const Ipopt::Number* x,
+   bool               new_x,
+   Ipopt::Index       nrows,
+   const Ipopt::Index* rows,
+   Ipopt::Index*      rowstart,
+   Ipopt::Index*      cols,
+   Ipopt::Number*     values
+)
+{
+   assert(n == gmoN(gmo));
+   assert(rows != NULL);
+
+   {
+      std::lock_guard<std::mutex> lock(gmostate->mutex);
+      setupJacobian();
+   }
+
+   if( rowstart != NULL )
+   {
+      rowstart[0] = 0;
+      for( Index r = 0; r < nrows; ++r )
       {
-         ++domviolations;
-         return false;
+         assert(rows[r] >= 0 && rows[r] < gmoM(gmo));
+         int len = iRowStart[rows[r]+1] - iRowStart[rows[r]];
+         if( cols != NULL )
+            memcpy(cols + rowstart[r], jCol + iRowStart[rows[r]], len * sizeof(int));
+         rowstart[r+1] = rowstart[r] + len;
       }
-
-      int next = iRowStart[i+1];
-      for( int k = iRowStart[i]; k < next; ++k, ++values )
-         *values = grad[jCol[k]];
    }
 
-   return true;
+   if( values == NULL )
+      return true;
+
+   assert(NULL != x);
+
+   EvalContext& ctx = getContext();
+   if( new_x )
+      ctx.newpoint = true;
+
+   return evalGradRows(ctx, x, nrows, rows, values, "eval_grad_gi_batch");
 }
 
 bool GamsMINLP::eval_h(
@@ -677,6 +913,7 @@ bool GamsMINLP::eval_h(
       assert(NULL != iRow);
       assert(NULL != jCol);
 
+      std::lock_guard<std::mutex> lock(gmostate->mutex);
       gmoHessLagStruct(gmo, iRow, jCol);
    }
    else
@@ -688,8 +925,10 @@ bool GamsMINLP::eval_h(
       assert(NULL == iRow);
       assert(NULL == jCol);
 
+      EvalContext& ctx = getContext();
       if( new_x )
-         gmoEvalNewPoint(gmo, x);
+         ctx.newpoint = true;
+      std::unique_lock<std::mutex> lock(lockGmo(ctx, x));
 
       // for GAMS, lambda would need to be multiplied by -1, we do this via the constraint weight
       int nerror;
@@ -700,7 +939,7 @@ bool GamsMINLP::eval_h(
          char buffer[256];
          sprintf(buffer, "Critical error detected %d in evaluation of Hessian!\n"
             "Exiting from subroutine - eval_h\n", rc);
-         gevLogStatPChar(gev, buffer);
+         logStat(buffer);
          throw -1;
       }
       if( nerror > 0 )
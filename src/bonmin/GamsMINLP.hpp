@@ -8,6 +8,14 @@
 #define GAMSMINLP_HPP_
 
 #include "BonTMINLP.hpp"
+#include "GamsNLEval.hpp"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 class GamsBonmin;
 class GamsCouenne;
@@ -16,7 +24,14 @@ class GamsCouenneSetup;
 struct gmoRec;
 struct gevRec;
 
-/** a TMINLP for Bonmin that uses GMO to interface the problem formulation */
+/** a TMINLP for Bonmin that uses GMO to interface the problem formulation
+ *
+ * The evaluation routines can be called from several threads at the same time.
+ * Each thread gets its own working memory.
+ * Calls into GMO are serialized, and GMO is moved to the point of the calling thread if another thread has evaluated in between.
+ * This also holds for copies of a GamsMINLP, which can be used to solve the same problem with different solvers at the same time.
+ * If paralleleval is set, rows that can be compiled into a GamsNLEvaluator are evaluated without going through GMO.
+ */
 class GamsMINLP : public Bonmin::TMINLP
 {
    friend class GamsBonmin;
@@ -32,7 +47,30 @@ private:
 
    int*                  iRowStart;          /**< row starts in jacobian */
    int*                  jCol;               /**< column indicies in jacobian */
-   double*               grad;               /**< working memory for storing gradient values */
+
+   /** evaluation context of one thread */
+   struct EvalContext
+   {
+      std::vector<double> grad;              /**< working memory for storing gradient values */
+      GamsNLEvaluator::Workspace ws;         /**< working memory for evaluator */
+      bool               newpoint;           /**< whether the thread has moved to a point that GMO has not seen yet */
+   };
+
+   std::mutex            contextmutex;       /**< protects contexts */
+   std::map<std::thread::id, EvalContext> contexts; /**< evaluation context of each thread */
+   /** state of GMO that is shared by all copies of a GamsMINLP */
+   struct GmoState
+   {
+      std::mutex         mutex;              /**< serializes calls into GMO and setup of jacobian structure */
+      const EvalContext* point;              /**< context whose point GMO has been evaluated at last, or NULL */
+
+      GmoState()
+      : point(NULL)
+      { }
+   };
+
+   std::shared_ptr<GmoState> gmostate;       /**< state of GMO */
+   GamsNLEvaluator*      nleval;             /**< evaluator for rows that do not need GMO, or NULL */
 
    bool                  in_couenne;         /**< whether we use this class in Couenne */
 
@@ -43,18 +81,60 @@ private:
    /** initializes sosinfo and branchinginfo */
    void setupPrioritiesSOS();
 
+   /** prints a message to the log and status file, synchronized with other threads by logmutex, if set */
+   void logStat(
+      const char*        msg                 /**< message */
+   );
+
+   /** gives the evaluation context of the calling thread, creating it if necessary */
+   EvalContext& getContext();
+
+   /** locks GMO for the calling thread and makes sure GMO is at the point of the thread */
+   std::unique_lock<std::mutex> lockGmo(
+      EvalContext&       ctx,                /**< evaluation context of calling thread */
+      const Ipopt::Number* x                 /**< point of calling thread */
+   );
+
+   /** sets up jacobian structure and, if paralleleval is set, the evaluator, unless already done
+    *
+    * Needs to be called with the mutex of gmostate locked.
+    */
+   void setupJacobian();
+
+   /** evaluates gradients of rows at a point, storing them row after row in the order of the jacobian structure
+    *
+    * Returns false if there was a domain error.
+    */
+   bool evalGradRows(
+      EvalContext&       ctx,                /**< evaluation context of calling thread */
+      const Ipopt::Number* x,                /**< point */
+      int                nrows,              /**< number of rows */
+      const int*         rows,               /**< indices of rows, or NULL for rows 0..nrows-1 */
+      Ipopt::Number*     values,             /**< buffer for gradient values */
+      const char*        caller              /**< name of calling routine, for error messages */
+   );
+
 public:
    double                div_iter_tol;       /**< value above which divergence is claimed */
    double                clockStart;         /**< time when optimization started */
-   long int              domviolations;      /**< number of domain violations */
+   std::atomic<long int> domviolations;      /**< number of domain violations */
    int                   model_status;       /**< holds GAMS model status when solve finished */
    int                   solver_status;      /**< holds GAMS model status when solve finished */
+   bool                  paralleleval;       /**< whether to evaluate rows by a compiled evaluator where possible */
+   int                   nlpthreads;         /**< number of threads for linear algebra in each thread that evaluates, or 0 to leave unchanged */
+   std::shared_ptr<std::mutex> logmutex;     /**< mutex to sync gevLog calls with other threads that print, or empty */
+   const std::atomic<bool>* interrupt;       /**< if set and true, then evaluations of objective and constraints fail, so that NLP solves end */
 
    GamsMINLP(
       struct gmoRec*     gmo_,               /**< GAMS modeling object */
       bool               in_couenne_ = false /**< whether the MINLP is used within Couenne */
       );
 
+   /** creates a copy that evaluates via the same GMO, but with its own evaluation contexts and solution status */
+   GamsMINLP(
+      const GamsMINLP&   other               /**< MINLP to copy */
+   );
+
    ~GamsMINLP();
 
    /** whether we have variables in SOS that can take negative values */
@@ -160,6 +240,23 @@ public:
       Ipopt::Number*     values
    );
 
+   /** evaluates the gradients of several constraints at one point
+    *
+    * If rowstart is not NULL, the sparsity pattern is stored in compressed row format in rowstart (nrows+1 entries) and, if not NULL, cols.
+    * If values is not NULL, the gradient values are stored in values, in the same order.
+    * GMO is moved to the new point at most once and only the entries of the evaluated rows are touched in the working memory.
+    */
+   bool eval_grad_gi_batch(
+      Ipopt::Index       n,
+      const Ipopt::Number* x,
+      bool               new_x,
+      Ipopt::Index       nrows,
+      const Ipopt::Index* rows,
+      Ipopt::Index*      rowstart,
+      Ipopt::Index*      cols,
+      Ipopt::Number*     values
+   );
+
    bool eval_h(
       Ipopt::Index       n,
       const Ipopt::Number* x,
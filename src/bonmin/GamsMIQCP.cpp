@@ -0,0 +1,320 @@
+// Copyright (C) GAMS Development and others
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// Author: Stefan Vigerske
+
+#include "GamsMIQCP.hpp"
+#include "GamsLinksConfig.h"
+
+#include <climits>
+#include <cmath>
+#include <cstdio>
+
+#ifdef GAMSLINKS_HAS_CPLEX
+#include "cplex.h"
+#endif
+
+#include "gmomcc.h"
+#include "gevmcc.h"
+
+bool GamsMIQCPSolver::isMIQCP(
+   struct gmoRec*     gmo                 /**< GAMS modeling object */
+)
+{
+   if( gmoGetVarTypeCnt(gmo, gmovar_S1) > 0 || gmoGetVarTypeCnt(gmo, gmovar_S2) > 0 )
+      return false;
+
+   gmoUseQSet(gmo, 1);
+
+   bool ismiqcp = gmoGetObjOrder(gmo) <= gmoorder_Q;
+   for( int i = 0; i < gmoM(gmo) && ismiqcp; ++i )
+      switch( gmoGetEquTypeOne(gmo, i) )
+      {
+         case gmoequ_E:
+            // CPLEX accepts only inequalities as quadratic constraints
+            ismiqcp = gmoGetEquOrderOne(gmo, i) == gmoorder_L;
+            break;
+         case gmoequ_L:
+         case gmoequ_G:
+            ismiqcp = gmoGetEquOrderOne(gmo, i) <= gmoorder_Q;
+            break;
+         case gmoequ_N:
+            break;
+         default:
+            ismiqcp = false;
+      }
+
+   gmoUseQSet(gmo, 0);
+
+   return ismiqcp;
+}
+
+bool GamsMIQCPSolver::solve(
+   double             timelimit,          /**< time limit */
+   int                nodelimit,          /**< node limit */
+   double             optca,              /**< absolute gap tolerance */
+   double             optcr,              /**< relative gap tolerance */
+   int                threads             /**< number of threads */
+)
+{
+#ifdef GAMSLINKS_HAS_CPLEX
+   char buffer[CPXMESSAGEBUFSIZE];
+   int status;
+
+   CPXENVptr env = CPXopenCPLEX(&status);
+   if( env == NULL )
+   {
+      CPXgeterrorstring(NULL, status, buffer);
+      gevLogStat(gev, buffer);
+      return false;
+   }
+
+   CPXLPptr lp = CPXcreateprob(env, &status, "bonmin_miqcp");
+   if( lp == NULL )
+   {
+      CPXgeterrorstring(env, status, buffer);
+      gevLogStat(gev, buffer);
+      CPXcloseCPLEX(&env);
+      return false;
+   }
+
+   int n = gmoN(gmo);
+   int m = gmoM(gmo);
+
+   gmoUseQSet(gmo, 1);
+
+   // variables and linear part of objective
+   double* lb = new double[n];
+   double* ub = new double[n];
+   char* ctype = new char[n];
+   gmoGetVarLower(gmo, lb);
+   gmoGetVarUpper(gmo, ub);
+   for( int j = 0; j < n; ++j )
+   {
+      if( lb[j] <= gmoMinf(gmo) )
+         lb[j] = -CPX_INFBOUND;
+      if( ub[j] >= gmoPinf(gmo) )
+         ub[j] = CPX_INFBOUND;
+      switch( gmoGetVarTypeOne(gmo, j) )
+      {
+         case gmovar_B:
+            ctype[j] = CPX_BINARY;
+            break;
+         case gmovar_I:
+            ctype[j] = CPX_INTEGER;
+            break;
+         default:
+            ctype[j] = CPX_CONTINUOUS;
+      }
+   }
+
+   int* colidx = new int[n];
+   double* coef = new double[n];
+   int* nlflag = new int[n];
+   double* objcoef = new double[n];
+   int nz;
+   int nlnz;
+
+   for( int j = 0; j < n; ++j )
+      objcoef[j] = 0.0;
+   gmoGetObjSparse(gmo, colidx, coef, nlflag, &nz, &nlnz);
+   for( int k = 0; k < nz; ++k )
+      objcoef[colidx[k]] = coef[k];
+
+   status = CPXnewcols(env, lp, n, objcoef, lb, ub, ctype, NULL);
+   if( status == 0 )
+      status = CPXchgobjsen(env, lp, gmoSense(gmo) == gmoObj_Min ? CPX_MIN : CPX_MAX);
+   if( status == 0 )
+      status = CPXchgobjoffset(env, lp, gmoObjConst(gmo));
+
+   delete[] objcoef;
+   delete[] lb;
+   delete[] ub;
+   delete[] ctype;
+
+   int maxqnz = gmoMaxQNZ(gmo);
+   if( gmoGetObjOrder(gmo) == gmoorder_Q && gmoObjQNZ(gmo) > maxqnz )
+      maxqnz = gmoObjQNZ(gmo);
+   int* qcol = new int[maxqnz];
+   int* qrow = new int[maxqnz];
+   double* qcoef = new double[maxqnz];
+
+   // quadratic part of objective: CPLEX wants the full symmetric matrix Q of 0.5 x^T Q x
+   // GMO gives each coefficient of x_i*x_j once and twice the coefficient of x_i^2, so these are the entries of Q
+   if( status == 0 && gmoGetObjOrder(gmo) == gmoorder_Q )
+   {
+      int qnz = gmoObjQNZ(gmo);
+      gmoGetObjQ(gmo, qcol, qrow, qcoef);
+
+      int* qmatcnt = new int[n];
+      int* qmatbeg = new int[n];
+      int* qmatind = new int[2*qnz];
+      double* qmatval = new double[2*qnz];
+
+      for( int j = 0; j < n; ++j )
+         qmatcnt[j] = 0;
+      for( int k = 0; k < qnz; ++k )
+      {
+         ++qmatcnt[qcol[k]];
+         if( qrow[k] != qcol[k] )
+            ++qmatcnt[qrow[k]];
+      }
+      qmatbeg[0] = 0;
+      for( int j = 1; j < n; ++j )
+         qmatbeg[j] = qmatbeg[j-1] + qmatcnt[j-1];
+      for( int j = 0; j < n; ++j )
+         qmatcnt[j] = 0;
+      for( int k = 0; k < qnz; ++k )
+      {
+         int pos = qmatbeg[qcol[k]] + qmatcnt[qcol[k]]++;
+         qmatind[pos] = qrow[k];
+         qmatval[pos] = qcoef[k];
+         if( qrow[k] != qcol[k] )
+         {
+            pos = qmatbeg[qrow[k]] + qmatcnt[qrow[k]]++;
+            qmatind[pos] = qcol[k];
+            qmatval[pos] = qcoef[k];
+         }
+      }
+
+      status = CPXcopyquad(env, lp, qmatbeg, qmatcnt, qmatind, qmatval);
+
+      delete[] qmatcnt;
+      delete[] qmatbeg;
+      delete[] qmatind;
+      delete[] qmatval;
+   }
+
+   // constraints: linear ones as rows, quadratic ones as quadratic constraints
+   for( int i = 0; i < m && status == 0; ++i )
+   {
+      char sense;
+      switch( gmoGetEquTypeOne(gmo, i) )
+      {
+         case gmoequ_E:
+            sense = 'E';
+            break;
+         case gmoequ_L:
+            sense = 'L';
+            break;
+         case gmoequ_G:
+            sense = 'G';
+            break;
+         default:
+            continue;
+      }
+
+      double rhs = gmoGetRhsOne(gmo, i);
+      gmoGetRowSparse(gmo, i, colidx, coef, nlflag, &nz, &nlnz);
+
+      if( gmoGetEquOrderOne(gmo, i) == gmoorder_L )
+      {
+         int beg = 0;
+         status = CPXaddrows(env, lp, 0, 1, nz, &rhs, &sense, &beg, colidx, coef, NULL, NULL);
+         continue;
+      }
+
+      // CPLEX takes x^T Q x, so the doubled coefficients of x_i^2 from GMO need to be halved
+      int qnz = gmoGetRowQNZOne(gmo, i);
+      gmoGetRowQ(gmo, i, qcol, qrow, qcoef);
+      for( int k = 0; k < qnz; ++k )
+         if( qcol[k] == qrow[k] )
+            qcoef[k] /= 2.0;
+
+      status = CPXaddqconstr(env, lp, nz, qnz, rhs, sense, colidx, coef, qrow, qcol, qcoef, NULL);
+   }
+
+   gmoUseQSet(gmo, 0);
+
+   delete[] colidx;
+   delete[] coef;
+   delete[] nlflag;
+   delete[] qcol;
+   delete[] qrow;
+   delete[] qcoef;
+
+   if( status == 0 )
+   {
+      CPXsetintparam(env, CPX_PARAM_SCRIND, CPX_OFF);
+      CPXsetdblparam(env, CPX_PARAM_TILIM, timelimit);
+      if( nodelimit < INT_MAX )
+         CPXsetlongparam(env, CPX_PARAM_NODELIM, nodelimit);
+      CPXsetdblparam(env, CPX_PARAM_EPAGAP, optca);
+      CPXsetdblparam(env, CPX_PARAM_EPGAP, optcr);
+      CPXsetintparam(env, CPX_PARAM_THREADS, threads);
+
+      status = CPXmipopt(env, lp);
+   }
+
+   if( status != 0 )
+   {
+      // e.g., CPXERR_Q_NOT_POS_DEF if a quadratic function is not convex
+      CPXgeterrorstring(env, status, buffer);
+      gevLog(gev, buffer);
+      CPXfreeprob(env, &lp);
+      CPXcloseCPLEX(&env);
+      return false;
+   }
+
+   int primalfeas;
+   CPXsolninfo(env, lp, NULL, NULL, &primalfeas, NULL);
+   bool hassol = primalfeas != 0;
+
+   bool result = true;
+   solver_status = gmoSolveStat_Normal;
+   switch( CPXgetstat(env, lp) )
+   {
+      case CPXMIP_OPTIMAL:
+         model_status = gmoModelStat_OptimalGlobal;
+         break;
+      case CPXMIP_OPTIMAL_TOL:
+         // optimal only within the gap tolerances
+         model_status = gmoNDisc(gmo) > 0 ? gmoModelStat_Integer : gmoModelStat_Feasible;
+         break;
+      case CPXMIP_INFEASIBLE:
+         model_status = gmoModelStat_InfeasibleNoSolution;
+         hassol = false;
+         break;
+      case CPXMIP_TIME_LIM_FEAS:
+      case CPXMIP_TIME_LIM_INFEAS:
+         solver_status = gmoSolveStat_Resource;
+         break;
+      case CPXMIP_NODE_LIM_FEAS:
+      case CPXMIP_NODE_LIM_INFEAS:
+         solver_status = gmoSolveStat_Iteration;
+         break;
+      case CPXMIP_ABORT_FEAS:
+      case CPXMIP_ABORT_INFEAS:
+         solver_status = gmoSolveStat_User;
+         break;
+      default:
+         // e.g., unbounded: leave it to Bonmin
+         result = false;
+   }
+   if( solver_status != gmoSolveStat_Normal )
+      model_status = hassol ? (gmoNDisc(gmo) > 0 ? gmoModelStat_Integer : gmoModelStat_Feasible) : gmoModelStat_NoSolutionReturned;
+
+   if( result )
+   {
+      x.clear();
+      if( hassol )
+      {
+         x.resize(n);
+         CPXgetx(env, lp, x.data(), 0, n-1);
+         CPXgetobjval(env, lp, &objval);
+      }
+      if( CPXgetbestobjval(env, lp, &bestbound) != 0 )
+         bestbound = gmoSense(gmo) == gmoObj_Min ? -HUGE_VAL : HUGE_VAL;
+      nnodes = CPXgetnodecnt(env, lp);
+      niterations = CPXgetmipitcnt(env, lp);
+   }
+
+   CPXfreeprob(env, &lp);
+   CPXcloseCPLEX(&env);
+
+   return result;
+#else
+   return false;
+#endif
+}
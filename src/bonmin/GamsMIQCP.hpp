@@ -0,0 +1,71 @@
+// Copyright (C) GAMS Development and others
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// Author: Stefan Vigerske
+
+#ifndef GAMSMIQCP_HPP_
+#define GAMSMIQCP_HPP_
+
+#include <vector>
+
+struct gmoRec;
+struct gevRec;
+
+/** solves a MIQCP given by GMO with CPLEX, passing quadratic functions as they are
+ *
+ * For a MIQCP with convex quadratic functions, the master problem of an outer approximation decomposition
+ * with the quadratic constraints kept instead of linearized is the MIQCP itself.
+ * Thus, a MILP solver that handles convex quadratic constraints solves the problem without any OA iterations.
+ */
+class GamsMIQCPSolver
+{
+private:
+   struct gmoRec*        gmo;                /**< GAMS modeling object */
+   struct gevRec*        gev;                /**< GAMS environment */
+
+public:
+   std::vector<double>   x;                  /**< best solution, empty if none */
+   double                objval;             /**< objective value of best solution */
+   double                bestbound;          /**< best bound */
+   long int              nnodes;             /**< number of nodes */
+   long int              niterations;        /**< number of simplex or barrier iterations */
+   int                   model_status;       /**< GAMS model status */
+   int                   solver_status;      /**< GAMS solver status */
+
+   GamsMIQCPSolver(
+      struct gmoRec*     gmo_,               /**< GAMS modeling object */
+      struct gevRec*     gev_                /**< GAMS environment */
+   )
+   : gmo(gmo_),
+     gev(gev_),
+     objval(0.0),
+     bestbound(0.0),
+     nnodes(0),
+     niterations(0),
+     model_status(0),
+     solver_status(0)
+   { }
+
+   /** checks whether the model can be passed to CPLEX as MIQCP
+    *
+    * This is the case if the objective is at most quadratic, all nonlinear constraints are quadratic inequalities, and there are no SOS.
+    */
+   static bool isMIQCP(
+      struct gmoRec*     gmo                 /**< GAMS modeling object */
+   );
+
+   /** builds the MIQCP and solves it with CPLEX
+    *
+    * Returns false if CPLEX is not available, failed, e.g., because a quadratic function is not convex, or did not reach a result that can be reported.
+    */
+   bool solve(
+      double             timelimit,          /**< time limit */
+      int                nodelimit,          /**< node limit */
+      double             optca,              /**< absolute gap tolerance */
+      double             optcr,              /**< relative gap tolerance */
+      int                threads             /**< number of threads */
+   );
+};
+
+#endif /* GAMSMIQCP_HPP_ */
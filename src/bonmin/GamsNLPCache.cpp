@@ -0,0 +1,227 @@
+// Copyright (C) GAMS Development and others
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// Author: Stefan Vigerske
+
+#include "GamsNLPCache.hpp"
+#include "GamsHelper.h"
+
+#include <algorithm>
+#include <typeinfo>
+
+#include "BonTMINLP2TNLP.hpp"
+
+using namespace Ipopt;
+using namespace Bonmin;
+
+std::size_t GamsNLPCache::hashDiscrete(
+   const std::vector<double>& bounds      /**< bounds as in Entry::bounds */
+) const
+{
+   std::size_t n = isdiscrete.size();
+   uint64_t h = GAMS_FNV1A_INIT;
+   for( std::size_t j = 0; j < n; ++j )
+      if( isdiscrete[j] )
+      {
+         h = GAMShashDoubles(h, &bounds[j], 1);
+         h = GAMShashDoubles(h, &bounds[n+j], 1);
+      }
+
+   return h;
+}
+
+void GamsNLPCache::unlink(
+   std::unordered_multimap<std::size_t, std::list<Entry>::iterator>& map, /**< hash map */
+   std::size_t        key,                /**< hash of entry */
+   std::list<Entry>::iterator it          /**< entry */
+)
+{
+   auto range = map.equal_range(key);
+   for( auto m = range.first; m != range.second; ++m )
+      if( m->second == it )
+      {
+         map.erase(m);
+         return;
+      }
+}
+
+bool GamsNLPCache::lookup(
+   const std::vector<double>& bounds,     /**< lower and upper bounds on variables, then on constraints */
+   Entry&             result,             /**< buffer to store result */
+   Entry&             start               /**< buffer to store result of a similar NLP */
+)
+{
+   std::lock_guard<std::mutex> lock(mutex);
+
+   start.x.clear();
+   if( !enabled )
+      return false;
+
+   ++nlookups;
+
+   auto range = byhash.equal_range(GAMShashDoubles(GAMS_FNV1A_INIT, bounds.data(), bounds.size()));
+   for( auto m = range.first; m != range.second; ++m )
+      if( m->second->bounds == bounds )
+      {
+         result = *m->second;
+         // move to front, so it is evicted last
+         entries.splice(entries.begin(), entries, m->second);
+         ++nhits;
+         return true;
+      }
+
+   std::size_t n = isdiscrete.size();
+   range = bydiscrete.equal_range(hashDiscrete(bounds));
+   for( auto m = range.first; m != range.second; ++m )
+   {
+      const std::vector<double>& other = m->second->bounds;
+      std::size_t j;
+      for( j = 0; j < n; ++j )
+         if( isdiscrete[j] && (other[j] != bounds[j] || other[n+j] != bounds[n+j]) )
+            break;
+      if( j == n )
+      {
+         start = *m->second;
+         ++nwarmstarts;
+         break;
+      }
+   }
+
+   return false;
+}
+
+void GamsNLPCache::store(
+   Entry&             result              /**< result, its bounds must be set; content is moved into cache */
+)
+{
+   std::lock_guard<std::mutex> lock(mutex);
+
+   if( !enabled || maxsize == 0 )
+      return;
+
+   result.boundshash = GAMShashDoubles(GAMS_FNV1A_INIT, result.bounds.data(), result.bounds.size());
+
+   // another thread may have stored the same NLP in the meantime
+   auto range = byhash.equal_range(result.boundshash);
+   for( auto m = range.first; m != range.second; ++m )
+      if( m->second->bounds == result.bounds )
+         return;
+
+   result.discretehash = hashDiscrete(result.bounds);
+
+   entries.push_front(std::move(result));
+   byhash.emplace(entries.front().boundshash, entries.begin());
+   bydiscrete.emplace(entries.front().discretehash, entries.begin());
+
+   if( entries.size() > maxsize )
+   {
+      std::list<Entry>::iterator last = std::prev(entries.end());
+      unlink(byhash, last->boundshash, last);
+      unlink(bydiscrete, last->discretehash, last);
+      entries.pop_back();
+   }
+}
+
+void GamsNLPCache::getSolutions(
+   std::vector<std::vector<double> >& xs, /**< buffer to store solutions */
+   std::vector<double>& solvetimes        /**< buffer to store solving times */
+)
+{
+   std::lock_guard<std::mutex> lock(mutex);
+
+   for( std::list<Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it )
+      if( it->status == TNLPSolver::solvedOptimal || it->status == TNLPSolver::solvedOptimalTol )
+      {
+         xs.push_back(it->x);
+         solvetimes.push_back(it->solvetime);
+      }
+}
+
+GamsNLPCacheSolver::GamsNLPCacheSolver(
+   const IpoptSolver& solver,             /**< solver to copy options from */
+   std::shared_ptr<GamsNLPCache> cache_   /**< cache of NLP results */
+)
+: IpoptSolver(solver),
+  cache(cache_),
+  lastcached(false)
+{
+   // the copy constructor of IpoptSolver sets up a new IpoptApplication, which still needs to be initialized
+   getIpoptApp().Initialize("");
+}
+
+GamsNLPCacheSolver::GamsNLPCacheSolver(
+   const GamsNLPCacheSolver& other        /**< solver to copy */
+)
+: IpoptSolver(other),
+  cache(other.cache),
+  lastcached(false)
+{
+   getIpoptApp().Initialize("");
+}
+
+SmartPtr<TNLPSolver> GamsNLPCacheSolver::clone()
+{
+   return new GamsNLPCacheSolver(*this);
+}
+
+TNLPSolver::ReturnStatus GamsNLPCacheSolver::solve(
+   const SmartPtr<TNLP>& tnlp,            /**< NLP to solve */
+   bool               resolve             /**< whether to reoptimize */
+)
+{
+   lastcached = false;
+
+   // only NLPs that are given by the MINLP with modified bounds can be identified by their bounds
+   // the NLPs of the feasibility pump or with added cuts are different problems
+   TMINLP2TNLP* problem = dynamic_cast<TMINLP2TNLP*>(GetRawPtr(tnlp));
+   if( problem == NULL || typeid(*problem) != typeid(TMINLP2TNLP) )
+      return resolve ? IpoptSolver::ReOptimizeTNLP(tnlp) : IpoptSolver::OptimizeTNLP(tnlp);
+
+   Index n, m, nnz_jac_g, nnz_h_lag;
+   TNLP::IndexStyleEnum index_style;
+   problem->get_nlp_info(n, m, nnz_jac_g, nnz_h_lag, index_style);
+
+   std::vector<double> bounds(2*(n+m));
+   problem->get_bounds_info(n, bounds.data(), bounds.data()+n, m, bounds.data()+2*n, bounds.data()+2*n+m);
+
+   GamsNLPCache::Entry result;
+   GamsNLPCache::Entry start;
+   if( cache->lookup(bounds, result, start) )
+   {
+      problem->finalize_solution(result.ipoptstatus, n, result.x.data(), result.duals.data(), result.duals.data()+n,
+         m, result.g.data(), result.duals.data()+2*n, result.obj, NULL, NULL);
+      lastcached = true;
+      return result.status;
+   }
+
+   // start from the solution of an NLP with the same integer fixings
+   if( !start.x.empty() )
+   {
+      for( Index j = 0; j < n; ++j )
+         start.x[j] = std::min(std::max(start.x[j], bounds[j]), bounds[n+j]);
+      problem->setxInit(n, start.x.data());
+      problem->setDualsInit(2*n+m, start.duals.data());
+   }
+
+   TNLPSolver::ReturnStatus status = resolve ? IpoptSolver::ReOptimizeTNLP(tnlp) : IpoptSolver::OptimizeTNLP(tnlp);
+
+   // keep only conclusive results, not those of solves that hit a limit
+   if( (status == TNLPSolver::solvedOptimal || status == TNLPSolver::solvedOptimalTol ||
+        status == TNLPSolver::provenInfeasible || status == TNLPSolver::unbounded) &&
+      problem->x_sol() != NULL )
+   {
+      result.bounds.swap(bounds);
+      result.status = status;
+      result.ipoptstatus = problem->optimization_status();
+      result.x.assign(problem->x_sol(), problem->x_sol() + n);
+      result.duals.assign(problem->duals_sol(), problem->duals_sol() + 2*n+m);
+      if( m > 0 )
+         result.g.assign(problem->g_sol(), problem->g_sol() + m);
+      result.obj = problem->obj_value();
+      result.solvetime = IpoptSolver::CPUTime();
+      cache->store(result);
+   }
+
+   return status;
+}
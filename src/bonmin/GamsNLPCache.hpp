@@ -0,0 +1,183 @@
+// Copyright (C) GAMS Development and others
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// Author: Stefan Vigerske
+
+#ifndef GAMSNLPCACHE_HPP_
+#define GAMSNLPCACHE_HPP_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "BonIpoptSolver.hpp"
+
+/** cache of NLP results, keyed by the variable and constraint bounds of the NLP
+ *
+ * Bounds of discrete variables encode the integer fixings, so NLPs that Bonmin solves repeatedly
+ * for the same node, e.g., in heuristics, OA cut generation, and at the node itself, are solved only once.
+ * The cache is shared by all copies of a GamsNLPCacheSolver and can be accessed concurrently.
+ */
+class GamsNLPCache
+{
+public:
+   /** result of an NLP solve */
+   struct Entry
+   {
+      std::vector<double> bounds;            /**< lower and upper bounds on variables, then on constraints */
+      std::size_t        boundshash;         /**< hash of bounds */
+      std::size_t        discretehash;       /**< hash of bounds of discrete variables */
+      Bonmin::TNLPSolver::ReturnStatus status; /**< status returned by NLP solver */
+      Ipopt::SolverReturn ipoptstatus;       /**< status that has been passed to finalize_solution */
+      std::vector<double> x;                 /**< primal solution */
+      std::vector<double> duals;             /**< multipliers for lower and upper variable bounds, then for constraints */
+      std::vector<double> g;                 /**< constraint activities */
+      double             obj;                /**< objective value */
+      double             solvetime;          /**< time it took to solve the NLP */
+   };
+
+private:
+   std::mutex            mutex;              /**< protects all members */
+   bool                  enabled;            /**< whether lookups and stores are done */
+   std::size_t           maxsize;            /**< maximal number of entries */
+   std::vector<bool>     isdiscrete;         /**< whether a variable is discrete */
+   std::list<Entry>      entries;            /**< cached results, most recent first */
+   std::unordered_multimap<std::size_t, std::list<Entry>::iterator> byhash;        /**< entries by hash of all bounds */
+   std::unordered_multimap<std::size_t, std::list<Entry>::iterator> bydiscrete;    /**< entries by hash of discrete bounds */
+
+   long int              nlookups;           /**< number of lookups */
+   long int              nhits;              /**< number of lookups that found a result */
+   long int              nwarmstarts;        /**< number of lookups that found a starting point */
+
+   /** hashes the bounds of discrete variables */
+   std::size_t hashDiscrete(
+      const std::vector<double>& bounds      /**< bounds as in Entry::bounds */
+   ) const;
+
+   /** removes an entry from the hash maps */
+   static void unlink(
+      std::unordered_multimap<std::size_t, std::list<Entry>::iterator>& map, /**< hash map */
+      std::size_t        key,                /**< hash of entry */
+      std::list<Entry>::iterator it          /**< entry */
+   );
+
+public:
+   GamsNLPCache(
+      std::size_t        maxsize_,           /**< maximal number of entries */
+      const std::vector<bool>& isdiscrete_   /**< whether a variable is discrete */
+   )
+   : enabled(true),
+     maxsize(maxsize_),
+     isdiscrete(isdiscrete_),
+     nlookups(0),
+     nhits(0),
+     nwarmstarts(0)
+   { }
+
+   /** enables or disables the cache */
+   void setEnabled(
+      bool               enabled_            /**< whether to use the cache */
+   )
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      enabled = enabled_;
+   }
+
+   /** looks up the result of an NLP with given bounds
+    *
+    * If there is no result, but one for an NLP with the same bounds on discrete variables,
+    * then its primal and dual solution is returned in start and the function returns false.
+    * If there is nothing suitable, start.x is empty.
+    * Returns true if a result has been found.
+    */
+   bool lookup(
+      const std::vector<double>& bounds,     /**< lower and upper bounds on variables, then on constraints */
+      Entry&             result,             /**< buffer to store result */
+      Entry&             start               /**< buffer to store result of a similar NLP */
+   );
+
+   /** stores the result of an NLP, evicting the oldest result if the cache is full */
+   void store(
+      Entry&             result              /**< result, its bounds must be set; content is moved into cache */
+   );
+
+   /** gives the primal solutions of cached NLPs that have been solved to optimality and the time it took to solve them */
+   void getSolutions(
+      std::vector<std::vector<double> >& xs, /**< buffer to store solutions */
+      std::vector<double>& solvetimes        /**< buffer to store solving times */
+   );
+
+   /** number of lookups */
+   long int getNLookups() const
+   {
+      return nlookups;
+   }
+
+   /** number of lookups that found a result */
+   long int getNHits() const
+   {
+      return nhits;
+   }
+
+   /** number of lookups that found a starting point */
+   long int getNWarmStarts() const
+   {
+      return nwarmstarts;
+   }
+};
+
+/** Ipopt solver for Bonmin that looks up NLP results in a GamsNLPCache before solving */
+class GamsNLPCacheSolver : public Bonmin::IpoptSolver
+{
+private:
+   std::shared_ptr<GamsNLPCache> cache;      /**< cache of NLP results */
+   bool                  lastcached;         /**< whether the result of the last solve was taken from the cache */
+
+   /** solves an NLP or takes its result from the cache */
+   Bonmin::TNLPSolver::ReturnStatus solve(
+      const Ipopt::SmartPtr<Ipopt::TNLP>& tnlp, /**< NLP to solve */
+      bool               resolve             /**< whether to reoptimize */
+   );
+
+public:
+   GamsNLPCacheSolver(
+      const Bonmin::IpoptSolver& solver,     /**< solver to copy options from */
+      std::shared_ptr<GamsNLPCache> cache_   /**< cache of NLP results */
+   );
+
+   GamsNLPCacheSolver(
+      const GamsNLPCacheSolver& other        /**< solver to copy */
+   );
+
+   Ipopt::SmartPtr<Bonmin::TNLPSolver> clone();
+
+   Bonmin::TNLPSolver::ReturnStatus OptimizeTNLP(
+      const Ipopt::SmartPtr<Ipopt::TNLP>& tnlp
+   )
+   {
+      return solve(tnlp, false);
+   }
+
+   Bonmin::TNLPSolver::ReturnStatus ReOptimizeTNLP(
+      const Ipopt::SmartPtr<Ipopt::TNLP>& tnlp
+   )
+   {
+      return solve(tnlp, true);
+   }
+
+   double CPUTime()
+   {
+      return lastcached ? 0.0 : IpoptSolver::CPUTime();
+   }
+
+   int IterationCount()
+   {
+      return lastcached ? 0 : IpoptSolver::IterationCount();
+   }
+};
+
+#endif /* GAMSNLPCACHE_HPP_ */
@@ -0,0 +1,215 @@
+// Copyright (C) GAMS Development and others
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// Author: Stefan Vigerske
+
+#include "GamsOACuts.hpp"
+#include "GamsMINLP.hpp"
+#include "GamsHelper.h"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+
+#include "OsiRowCut.hpp"
+#include "CoinFinite.hpp"
+
+#include "gmomcc.h"
+
+/** version of file format */
+#define OAPOINTS_VERSION 1
+
+uint64_t GamsOAPointStore::fingerprint(
+   struct gmoRec*     gmo                 /**< GAMS modeling object */
+)
+{
+   int n = gmoN(gmo);
+   int m = gmoM(gmo);
+
+   uint64_t h = GAMS_FNV1A_INIT;
+   h = GAMShashInt(h, n);
+   h = GAMShashInt(h, m);
+
+   int* colidx  = new int[n];
+   double* coef = new double[n];
+   int* nlflag  = new int[n];
+   int* opcodes = new int[gmoNLCodeSizeMaxRow(gmo)+1];
+   int* fields  = new int[gmoNLCodeSizeMaxRow(gmo)+1];
+
+   // equation types, nonlinear sparsity pattern, and instruction codes of nonlinear rows
+   for( int i = 0; i < m; ++i )
+   {
+      if( gmoGetEquOrderOne(gmo, i) <= gmoorder_L )
+         continue;
+
+      h = GAMShashInt(h, i);
+      h = GAMShashInt(h, gmoGetEquTypeOne(gmo, i));
+
+      int nz, nlnz;
+      gmoGetRowSparse(gmo, i, colidx, coef, nlflag, &nz, &nlnz);
+      for( int k = 0; k < nz; ++k )
+         if( nlflag[k] )
+            h = GAMShashInt(h, colidx[k]);
+
+      int codelen;
+      gmoDirtyGetRowFNLInstr(gmo, i, &codelen, opcodes, fields);
+      for( int k = 0; k < codelen; ++k )
+         h = GAMShashInt(h, opcodes[k]);
+   }
+
+   delete[] colidx;
+   delete[] coef;
+   delete[] nlflag;
+   delete[] opcodes;
+   delete[] fields;
+
+   return h;
+}
+
+double GamsOAPointStore::getSolveTime() const
+{
+   double total = 0.0;
+   for( size_t i = 0; i < solvetimes.size(); ++i )
+      total += solvetimes[i];
+   return total;
+}
+
+bool GamsOAPointStore::read(
+   struct gmoRec*     gmo,                /**< GAMS modeling object */
+   const char*        filename            /**< name of file */
+)
+{
+   FILE* f = fopen(filename, "r");
+   if( f == NULL )
+      return false;
+
+   int version;
+   uint64_t fp;
+   int n;
+   if( fscanf(f, "GAMSLINKS_OAPOINTS %d %" SCNx64 " %d", &version, &fp, &n) != 3 || version != OAPOINTS_VERSION
+      || fp != fingerprint(gmo) || n != gmoN(gmo) )
+   {
+      fclose(f);
+      return false;
+   }
+
+   std::vector<double> x(n);
+   double solvetime;
+   while( fscanf(f, "%lf", &solvetime) == 1 )
+   {
+      int j;
+      for( j = 0; j < n; ++j )
+         if( fscanf(f, "%lf", &x[j]) != 1 )
+            break;
+      if( j < n )
+         break;
+      add(x.data(), n, solvetime);
+   }
+
+   fclose(f);
+
+   return true;
+}
+
+bool GamsOAPointStore::write(
+   struct gmoRec*     gmo,                /**< GAMS modeling object */
+   const char*        filename            /**< name of file */
+) const
+{
+   FILE* f = fopen(filename, "w");
+   if( f == NULL )
+      return false;
+
+   fprintf(f, "GAMSLINKS_OAPOINTS %d %" PRIx64 " %d\n", OAPOINTS_VERSION, fingerprint(gmo), gmoN(gmo));
+   for( size_t i = 0; i < points.size(); ++i )
+   {
+      fprintf(f, "%.17g", solvetimes[i]);
+      for( size_t j = 0; j < points[i].size(); ++j )
+         fprintf(f, " %.17g", points[i][j]);
+      fprintf(f, "\n");
+   }
+
+   return fclose(f) == 0;
+}
+
+int GamsOAPointStore::generateCuts(
+   struct gmoRec*     gmo,                /**< GAMS modeling object */
+   GamsMINLP&         minlp,              /**< MINLP to evaluate constraints */
+   OsiCuts&           cuts                /**< storage for cuts */
+) const
+{
+   int n = gmoN(gmo);
+   int m = gmoM(gmo);
+
+   // nonlinear inequalities
+   std::vector<int> rows;
+   for( int i = 0; i < m; ++i )
+      if( gmoGetEquOrderOne(gmo, i) > gmoorder_L && (gmoGetEquTypeOne(gmo, i) == gmoequ_L || gmoGetEquTypeOne(gmo, i) == gmoequ_G) )
+         rows.push_back(i);
+
+   if( rows.empty() || points.empty() )
+      return 0;
+
+   int nrows = (int)rows.size();
+   std::vector<int> rowstart(nrows+1);
+   minlp.eval_grad_gi_batch(n, NULL, false, nrows, rows.data(), rowstart.data(), NULL, NULL);
+   std::vector<int> cols(rowstart[nrows]);
+   std::vector<double> grad(rowstart[nrows]);
+   minlp.eval_grad_gi_batch(n, NULL, false, nrows, rows.data(), rowstart.data(), cols.data(), NULL);
+
+   std::vector<double> rhs(m);
+   gmoGetRhs(gmo, rhs.data());
+
+   // evaluation errors at old points are no domain violations of this solve
+   long int domviolations = minlp.domviolations;
+
+   int ncuts = 0;
+   for( size_t p = 0; p < points.size(); ++p )
+   {
+      const double* x = points[p].data();
+
+      if( !minlp.eval_grad_gi_batch(n, x, true, nrows, rows.data(), NULL, NULL, grad.data()) )
+         continue;
+
+      for( int r = 0; r < nrows; ++r )
+      {
+         double val;
+         if( !minlp.eval_gi(n, x, false, rows[r], val) )
+            continue;
+
+         // g(x0) + grad g(x0) (x - x0) <= rhs  <=>  grad g(x0) x <= rhs - g(x0) + grad g(x0) x0
+         double side = rhs[rows[r]] - val;
+         bool valid = CoinFinite(side);
+         bool nonzero = false;
+         for( int k = rowstart[r]; k < rowstart[r+1] && valid; ++k )
+         {
+            valid = CoinFinite(grad[k]);
+            nonzero |= grad[k] != 0.0;
+            side += grad[k] * x[cols[k]];
+         }
+         if( !valid || !nonzero || !CoinFinite(side) )
+            continue;
+
+         OsiRowCut cut;
+         cut.setRow(rowstart[r+1] - rowstart[r], &cols[rowstart[r]], &grad[rowstart[r]]);
+         if( gmoGetEquTypeOne(gmo, rows[r]) == gmoequ_L )
+         {
+            cut.setLb(-COIN_DBL_MAX);
+            cut.setUb(side);
+         }
+         else
+         {
+            cut.setLb(side);
+            cut.setUb(COIN_DBL_MAX);
+         }
+         cut.setGloballyValid(true);
+         cuts.insert(cut);
+         ++ncuts;
+      }
+   }
+
+   minlp.domviolations = domviolations;
+
+   return ncuts;
+}
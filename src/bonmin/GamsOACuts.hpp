@@ -0,0 +1,83 @@
+// Copyright (C) GAMS Development and others
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// Author: Stefan Vigerske
+
+#ifndef GAMSOACUTS_HPP_
+#define GAMSOACUTS_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include "OsiCuts.hpp"
+
+class GamsMINLP;
+struct gmoRec;
+struct gevRec;
+
+/** linearization points for outer approximation cuts that can be stored in a file and reused when solving a MINLP with the same structure again
+ *
+ * Points are stored instead of cuts, so that cuts are computed from the current data of the MINLP.
+ * A file is accepted only if the fingerprint of the structure of the nonlinear constraints matches.
+ */
+class GamsOAPointStore
+{
+private:
+   std::vector<std::vector<double> > points; /**< linearization points */
+   std::vector<double>   solvetimes;         /**< time it took to solve the NLP that gave each point */
+
+   /** computes a fingerprint of the structure of the nonlinear constraints */
+   static uint64_t fingerprint(
+      struct gmoRec*     gmo                 /**< GAMS modeling object */
+   );
+
+public:
+   /** adds a point */
+   void add(
+      const double*      x,                  /**< point */
+      int                n,                  /**< number of variables */
+      double             solvetime           /**< time it took to find the point */
+   )
+   {
+      points.push_back(std::vector<double>(x, x+n));
+      solvetimes.push_back(solvetime);
+   }
+
+   /** number of points */
+   int getNPoints() const
+   {
+      return (int)points.size();
+   }
+
+   /** total time it took to find all points */
+   double getSolveTime() const;
+
+   /** reads points from a file
+    *
+    * Returns false if the file cannot be read or is for a MINLP with another structure.
+    */
+   bool read(
+      struct gmoRec*     gmo,                /**< GAMS modeling object */
+      const char*        filename            /**< name of file */
+   );
+
+   /** writes points to a file */
+   bool write(
+      struct gmoRec*     gmo,                /**< GAMS modeling object */
+      const char*        filename            /**< name of file */
+   ) const;
+
+   /** computes outer approximation cuts of nonlinear inequalities at all points
+    *
+    * The cuts are valid if the constraint functions are convex (=L=) or concave (=G=), which Bonmin assumes anyway.
+    * Returns the number of cuts that have been generated.
+    */
+   int generateCuts(
+      struct gmoRec*     gmo,                /**< GAMS modeling object */
+      GamsMINLP&         minlp,              /**< MINLP to evaluate constraints */
+      OsiCuts&           cuts                /**< storage for cuts */
+   ) const;
+};
+
+#endif /* GAMSOACUTS_HPP_ */
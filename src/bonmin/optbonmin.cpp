@@ -155,6 +155,15 @@ int main(int argc, char** argv)
       "yes",
       "no", "", "yes", "");
 
+   bonmin_setup.roptions()->SetRegisteringCategory("Linear Solver", Bonmin::RegisteredOptions::IpoptCategory);
+   bonmin_setup.roptions()->AddStringOption2("linear_solver_selection",
+      "Method to choose the linear solver.",
+      "fixed",
+      "fixed", "use linear solver as specified by option linear_solver",
+      "auto", "choose linear solver and ordering from size and density of the KKT system and the number of threads",
+      "With setting auto, the value of option linear_solver is overwritten. "
+      "The HSL solvers are considered only for BonminH.");
+
    bonmin_setup.roptions()->SetRegisteringCategory("Output and Loglevel", Bonmin::RegisteredOptions::BonminCategory);
 
    bonmin_setup.roptions()->AddStringOption1("solvetrace",
@@ -175,6 +184,22 @@ int main(int argc, char** argv)
       "yes",
       "no", "", "yes", "",
       "If enabled, then the dual values from the resolved NLP are made available in GAMS.");
+   bonmin_setup.roptions()->AddLowerBoundedIntegerOption("nlp_cache_size",
+      "Maximal number of NLP results to keep for reuse",
+      0, 100,
+      "If an NLP with the same variable and constraint bounds as a cached one is to be solved, then its result is taken from the cache. "
+      "If only the bounds on discrete variables coincide, then the cached solution is used as starting point. "
+      "Applies only if Ipopt is used as NLP solver and NLPs are not resolved from random starting points (num_resolve_at_root, num_resolve_at_node, num_resolve_at_infeasibles). "
+      "A value of 0 disables the cache.");
+
+   bonmin_setup.roptions()->SetRegisteringCategory("Options for MILP solver", Bonmin::RegisteredOptions::BonminCategory);
+   bonmin_setup.roptions()->AddStringOption2("milp_solver_quadratic",
+      "Whether to pass quadratic functions to the MILP solver instead of linearizing them",
+      "yes",
+      "no", "", "yes", "",
+      "Applies if milp_solver is Cplex, the algorithm is not B-BB, the objective is at most quadratic, and all nonlinear constraints are quadratic inequalities. "
+      "Then the master problem of the outer approximation with the quadratic functions kept is the MIQCP itself, which Cplex solves directly. "
+      "If Cplex fails, e.g., because a quadratic function is not convex, then Bonmin runs as usual.");
 
    bonmin_setup.roptions()->SetRegisteringCategory("Branch-and-bound options", Bonmin::RegisteredOptions::BonminCategory);
    bonmin_setup.roptions()->AddStringOption2("clocktype",
@@ -182,6 +207,29 @@ int main(int argc, char** argv)
       "wall",
       "cpu", "CPU time", "wall", "Wall-clock time",
       "");
+   bonmin_setup.roptions()->AddLowerBoundedIntegerOption("threads",
+      "Number of threads for parallel branch-and-bound",
+      0, 1,
+      "By default, branch-and-bound runs in a single thread. "
+      "If 0, the value of the GAMS threads option is used. "
+      "With more than one thread, nodes are processed in parallel, the NLP solver in each thread uses a single-threaded linear solver, "
+      "and equations are evaluated without going through GAMS where possible. "
+      "Requires that Cbc has been built with thread support.");
+   bonmin_setup.roptions()->AddStringOption1("race_algorithms",
+      "Algorithms to run in parallel, the first one to finish with a proven result determines the outcome",
+      "", "*",
+      "Space-separated list of algorithms (B-BB, B-OA, B-QG, B-Hyb, B-Ecp, B-iFP). "
+      "Each algorithm runs in its own thread on its own copy of the MINLP. Only the first algorithm prints its progress. "
+      "The runs share the objective value of the best solution found as cutoff. "
+      "If the list has less than two entries, then option algorithm is used.");
+   bonmin_setup.roptions()->AddStringOption1("oa_points_file",
+      "Name of file for storing linearization points for outer approximation cuts across solves",
+      "", "*",
+      "If the file exists and has been written for a MINLP with the same structure of nonlinear constraints, "
+      "then outer approximation cuts for nonlinear inequalities at the points from the file are added to the initial MILP relaxation. "
+      "At the end of the solve, the points of NLPs that have been solved to optimality are written to the file, "
+      "which requires that nlp_cache_size is positive. "
+      "Cuts are computed from the current data, but are valid only for convex (=L=) or concave (=G=) constraint functions.");
 
    const Bonmin::RegisteredOptions::RegOptionsList& optionlist(regoptions->RegisteredOptionsList());
 
@@ -6,17 +6,23 @@
 
 #include "GamsLinksConfig.h"
 #include "GamsCouenne.hpp"
+#include "GamsCouenneBounds.hpp"
 #include "GamsMINLP.hpp"
 #include "GamsJournal.hpp"
 #include "GamsMessageHandler.hpp"
 #include "GamsNLinstr.h"
 #include "GamsCbcHeurSolveTrace.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <climits>
 #include <list>
+#include <thread>
+#include <string>
+#include <vector>
 
 // dos compiler does not know PI
 #ifndef M_PI
@@ -37,6 +43,8 @@
 
 #include "CbcBranchActual.hpp"  // for CbcSOS
 #include "CbcBranchLotsize.hpp" // for CbcLotsize
+#include "CoinTime.hpp"
+#include "OsiClpSolverInterface.hpp"
 #include "CouenneBab.hpp"
 #include "BonCouenneSetup.hpp"
 #include "BonCouenneInterface.hpp"
@@ -56,12 +64,12 @@
 #include "CouenneExprMul.hpp"
 #include "CouenneExprOpp.hpp"
 #include "CouenneExprPow.hpp"
+#include "CouenneExprQuad.hpp"
 #include "CouenneExprSin.hpp"
 #include "CouenneExprSub.hpp"
 #include "CouenneExprSum.hpp"
 #include "CouenneExprVar.hpp"
-//#include "exprQuad.hpp"
-//#include "lqelems.hpp"
+#include "CouenneLQelems.hpp"
 
 #if defined(__linux) && defined(GAMSLINKS_HAS_CPLEX)
 #include "cplex.h"
@@ -160,6 +168,20 @@ int GamsCouenne::readyAPI(
       "cpu", "CPU time", "wall", "Wall-clock time",
       "");
 
+   couenne_setup->roptions()->SetRegisteringCategory("Couenne options", Bonmin::RegisteredOptions::CouenneCategory);
+   couenne_setup->roptions()->AddStringOption2("obbt_prepass",
+      "Whether to tighten variable bounds by optimality-based bound tightening on the root linear relaxation before branch-and-bound",
+      "no",
+      "no", "", "yes", "",
+      "The LPs that minimize and maximize each variable are distributed onto the number of threads given by the GAMS option threads.");
+
+   couenne_setup->roptions()->AddStringOption1("bounds_file",
+      "Name of file for reusing tightened variable bounds between runs on the same model.",
+      "", "*",
+      "If the file exists and has been written for a model with the same data, then its bounds are intersected with the variable bounds before solving. "
+      "In this case, the OBBT pre-pass is skipped. "
+      "After Couenne has been initialized, the tightened bounds are written to the file.");
+
    return 0;
 }
 
@@ -351,6 +373,42 @@ int GamsCouenne::callSolver()
       return 1;
    }
 
+   // intersect variable bounds with tightened bounds from a previous run on the same model
+   std::string boundsfile;
+   couenne_setup->options()->GetStringValue("bounds_file", boundsfile, "");
+   double cutoff = gevGetIntOpt(gev, gevUseCutOff) ? gevGetDblOpt(gev, gevCutOff) : gmoPinf(gmo);
+   bool boundsfromfile = false;
+   if( boundsfile != "" )
+   {
+      char buf[GMS_SSSIZE+100];
+      GamsCouenneBounds cached;
+      if( cached.read(gmo, cutoff, boundsfile.c_str()) )
+      {
+         int ntightened = 0;
+         for( int j = 0; j < gmoN(gmo); ++j )
+         {
+            double newl = std::max(problem->Lb(j), cached.lb[j]);
+            double newu = std::min(problem->Ub(j), cached.ub[j]);
+            // skip bounds that do not fit to the current ones
+            if( newl > newu )
+               continue;
+            if( newl > problem->Lb(j) || newu < problem->Ub(j) )
+               ++ntightened;
+            problem->Lb(j) = newl;
+            problem->Ub(j) = newu;
+         }
+         boundsfromfile = true;
+
+         snprintf(buf, sizeof(buf), "Tightened bounds of %d variables with bounds from file %s.\n", ntightened, boundsfile.c_str());
+         gevLogPChar(gev, buf);
+      }
+      else
+      {
+         snprintf(buf, sizeof(buf), "No bounds for this model in file %s.\n", boundsfile.c_str());
+         gevLogPChar(gev, buf);
+      }
+   }
+
    // setup MINLP
    SmartPtr<GamsMINLP> minlp = new GamsMINLP(gmo);
    minlp->in_couenne = true;
@@ -432,6 +490,38 @@ int GamsCouenne::callSolver()
          goto TERMINATE;
       }
 
+      bool obbtprepass;
+      couenne_setup->options()->GetBoolValue("obbt_prepass", obbtprepass, "");
+      if( obbtprepass && boundsfromfile )
+      {
+         gevLog(gev, "OBBT pre-pass skipped, since bounds have been read from file.");
+      }
+      else if( obbtprepass )
+      {
+         double starttime = gevTimeDiffStart(gev);
+         int nthreads = std::max(gevThreads(gev), 1);
+         int ntightened = tightenBoundsOBBT(problem, couenne_setup->continuousSolver(), nthreads,
+            gevGetDblOpt(gev, gevResLim) - (starttime - minlp->clockStart));
+
+         snprintf(buffer, 1024, "OBBT pre-pass tightened bounds of %d variables using %d threads (%g seconds).\n", ntightened, nthreads, gevTimeDiffStart(gev) - starttime);
+         gevLogPChar(gev, buffer);
+      }
+
+      if( boundsfile != "" )
+      {
+         // original variables are the first columns of the relaxation
+         const double* collb = couenne_setup->continuousSolver()->getColLower();
+         const double* colub = couenne_setup->continuousSolver()->getColUpper();
+         GamsCouenneBounds tightened;
+         tightened.lb.assign(collb, collb + gmoN(gmo));
+         tightened.ub.assign(colub, colub + gmoN(gmo));
+         if( !tightened.write(gmo, cutoff, boundsfile.c_str()) )
+         {
+            snprintf(buffer, 1024, "Could not write bounds to file %s.\n", boundsfile.c_str());
+            gevLogStatPChar(gev, buffer);
+         }
+      }
+
       // check time usage and reduce timelimit for B&B accordingly
       double preprocessTime = gevTimeDiffStart(gev) - minlp->clockStart;
 
@@ -713,6 +803,203 @@ bool GamsCouenne::isMIP()
    return gmoNLNZ(gmo) == 0 && (gmoObjStyle(gmo) == gmoObjType_Var || gmoObjNLNZ(gmo) == 0);
 }
 
+/** collects the quadratic terms of a function from GMO as elements for an exprQuad */
+static
+void getQuadElems(
+   CouenneProblem*    prob,               /**< Couenne problem */
+   int                qnz,                /**< number of quadratic terms */
+   const int*         qcol,               /**< first variable of each term */
+   const int*         qrow,               /**< second variable of each term */
+   const double*      quadcoefs,          /**< coefficient of each term */
+   double             factor,             /**< factor to multiply coefficients with */
+   std::vector<quadElem>& quad            /**< vector to store elements */
+)
+{
+   quad.clear();
+   quad.reserve(qnz);
+   for( int j = 0; j < qnz; ++j )
+   {
+      assert(qcol[j] >= 0);
+      assert(qrow[j] >= 0);
+      assert(qcol[j] < prob->nVars());
+      assert(qrow[j] < prob->nVars());
+      // for some strange reason, the coefficients on the diagonal are multiplied by 2 in GMO
+      double coef = (qcol[j] == qrow[j]) ? quadcoefs[j] / 2.0 : quadcoefs[j];
+      quad.push_back(quadElem(prob->Var(qcol[j]), prob->Var(qrow[j]), factor * coef));
+   }
+}
+
+/** prints GAMS instructions of a row to std::clog */
+static
+void printGamsInstructions(
+   struct gmoRec*     gmo,                /**< GAMS modeling object */
+   int                codelen,            /**< length of GAMS instructions */
+   const int*         opcodes,            /**< opcodes of GAMS instructions */
+   const int*         fields,             /**< fields of GAMS instructions */
+   const double*      constants           /**< GAMS constants pool */
+)
+{
+   for( int pos = 0; pos < codelen; ++pos )
+   {
+      GamsOpCode opcode = (GamsOpCode)opcodes[pos];
+      int address = fields[pos]-1;
+
+      std::clog << '\t' << GamsOpCodeName[opcode] << ": ";
+      switch( opcode )
+      {
+         case nlPushV:
+         case nlAddV:
+         case nlSubV:
+         case nlMulV:
+         case nlDivV:
+         case nlUMinV:
+            std::clog << "variable " << gmoGetjSolver(gmo, address);
+            break;
+
+         case nlPushI:
+         case nlAddI:
+         case nlSubI:
+         case nlMulI:
+         case nlMulIAdd:
+         case nlDivI:
+            std::clog << "constant " << constants[address];
+            break;
+
+         case nlFuncArgN:
+            std::clog << address+1 << " arguments";
+            break;
+
+         case nlCallArg1:
+         case nlCallArg2:
+         case nlCallArgN:
+            std::clog << "function " << GamsFuncCodeName[address+1];
+            break;
+
+         default:
+            break;
+      }
+      std::clog << std::endl;
+   }
+}
+
+int GamsCouenne::tightenBoundsOBBT(
+   CouenneProblem*    problem,            /**< Couenne problem, the bounds in its domain are updated */
+   OsiSolverInterface* relaxation,        /**< root linear relaxation, its column bounds are updated */
+   int                nthreads,           /**< number of threads */
+   double             timelimit           /**< time limit */
+)
+{
+   assert(problem != NULL);
+   assert(relaxation != NULL);
+   assert(relaxation->getNumCols() == problem->nVars());
+
+   int n = relaxation->getNumCols();
+   std::vector<double> lb(relaxation->getColLower(), relaxation->getColLower() + n);
+   std::vector<double> ub(relaxation->getColUpper(), relaxation->getColUpper() + n);
+
+   // variables that are used in the reformulation and not fixed
+   std::vector<int> cands;
+   for( int j = 0; j < n; ++j )
+      if( problem->Var(j)->Multiplicity() > 0 && lb[j] < ub[j] - COUENNE_EPS )
+         cands.push_back(j);
+   if( cands.empty() )
+      return 0;
+
+   // copy relaxation into a plain Clp interface, since resolve() of Couenne's solver interface does more than solving the LP
+   OsiClpSolverInterface lp;
+   std::vector<double> obj(n, 0.0);
+   lp.loadProblem(*relaxation->getMatrixByCol(), lb.data(), ub.data(), obj.data(), relaxation->getRowLower(), relaxation->getRowUpper());
+   lp.messageHandler()->setLogLevel(0);
+   lp.setHintParam(OsiDoReducePrint, true, OsiHintTry);
+   lp.initialSolve();
+   // if the relaxation is infeasible or the LP solve failed, leave it to Couenne to find out
+   if( !lp.isProvenOptimal() )
+      return 0;
+   // a change of the objective keeps the basis primal feasible, so warmstart with primal simplex
+   lp.setHintParam(OsiDoDualInResolve, false, OsiHintDo);
+
+   nthreads = std::min(nthreads, (int)cands.size());
+   std::vector<OsiSolverInterface*> lps(nthreads);
+   for( int t = 0; t < nthreads; ++t )
+      lps[t] = lp.clone();
+
+   // each candidate is handled by one thread only, so it can write its entries of newlb and newub without locking
+   std::vector<double> newlb(lb);
+   std::vector<double> newub(ub);
+   std::atomic<size_t> next(0);
+   std::atomic<bool> timeout(false);
+   double endtime = CoinWallclockTime() + timelimit;
+
+   auto work = [&](OsiSolverInterface* tlp)
+   {
+      for( size_t c = next++; c < cands.size(); c = next++ )
+      {
+         if( timeout || CoinWallclockTime() >= endtime )
+         {
+            timeout = true;
+            break;
+         }
+
+         int j = cands[c];
+         tlp->setObjCoeff(j, 1.0);
+         tlp->resolve();
+         if( tlp->isProvenOptimal() )
+            newlb[j] = tlp->getColSolution()[j];
+
+         tlp->setObjCoeff(j, -1.0);
+         tlp->resolve();
+         if( tlp->isProvenOptimal() )
+            newub[j] = tlp->getColSolution()[j];
+
+         tlp->setObjCoeff(j, 0.0);
+      }
+   };
+
+   std::vector<std::thread> threads;
+   for( int t = 1; t < nthreads; ++t )
+      threads.push_back(std::thread(work, lps[t]));
+   work(lps[0]);
+   for( size_t t = 0; t < threads.size(); ++t )
+      threads[t].join();
+
+   for( int t = 0; t < nthreads; ++t )
+      delete lps[t];
+
+   // relax LP solutions slightly to account for tolerances of the LP solver
+   int ntightened = 0;
+   for( size_t c = 0; c < cands.size(); ++c )
+   {
+      int j = cands[c];
+      double newl = newlb[j] - COUENNE_EPS * std::max(1.0, fabs(newlb[j]));
+      double newu = newub[j] + COUENNE_EPS * std::max(1.0, fabs(newub[j]));
+      if( problem->Var(j)->isInteger() )
+      {
+         newl = ceil(newl - COUENNE_EPS);
+         newu = floor(newu + COUENNE_EPS);
+      }
+      if( newl > newu )
+         continue;
+
+      bool tightened = false;
+      if( newl > lb[j] + COUENNE_EPS )
+      {
+         relaxation->setColLower(j, newl);
+         problem->Lb(j) = newl;
+         tightened = true;
+      }
+      if( newu < ub[j] - COUENNE_EPS )
+      {
+         relaxation->setColUpper(j, newu);
+         problem->Ub(j) = newu;
+         tightened = true;
+      }
+      if( tightened )
+         ++ntightened;
+   }
+
+   return ntightened;
+}
+
 CouenneProblem* GamsCouenne::setupProblem()
 {
    assert(gmo != NULL);
@@ -720,6 +1007,7 @@ CouenneProblem* GamsCouenne::setupProblem()
 
    CouenneProblem* prob = new CouenneProblem(NULL, NULL, couenne_setup->journalist());
    CouenneProblem* prob_ = NULL;
+   double starttime = gevTimeDiffStart(gev);
 
    gmoUseQSet(gmo, 1);
 
@@ -744,6 +1032,7 @@ CouenneProblem* GamsCouenne::setupProblem()
    int codelen;
 
    exprGroup::lincoeff lin;
+   std::vector<quadElem> quad;
    expression* body = NULL;
 
    double* x_ = new double[gmoN(gmo)];
@@ -797,34 +1086,12 @@ CouenneProblem* GamsCouenne::setupProblem()
 
       if( gmoGetObjOrder(gmo) == gmoorder_Q )
       {
-         // TODO: use exprQuad?
+         // pass the sparse Q matrix, so Couenne can treat the quadratic form as a whole
          qnz = gmoObjQNZ(gmo);
          gmoGetObjQ(gmo, qcol, qrow, quadcoefs);
-         expression** quadpart = new expression*[qnz];
-
-         for( int j = 0; j < qnz; ++j )
-         {
-            assert(qcol[j] >= 0);
-            assert(qrow[j] >= 0);
-            assert(qcol[j] < gmoN(gmo));
-            assert(qrow[j] < gmoN(gmo));
-            if( qcol[j] == qrow[j] )
-            {
-               quadcoefs[j] /= 2.0; // for some strange reason, the coefficients on the diagonal are multiplied by 2 in GMO
-               quadpart[j] = new exprPow(new exprClone(prob->Var(qcol[j])), new exprConst(2.0));
-            }
-            else
-            {
-               quadpart[j] = new exprMul(new exprClone(prob->Var(qcol[j])), new exprClone(prob->Var(qrow[j])));
-            }
-            quadcoefs[j] *= isMin;
-            if( quadcoefs[j] == -1.0 )
-               quadpart[j] = new exprOpp(quadpart[j]);
-            else if( quadcoefs[j] != 1.0 )
-               quadpart[j] = new exprMul(quadpart[j], new exprConst(quadcoefs[j]));
-         }
+         getQuadElems(prob, qnz, qcol, qrow, quadcoefs, isMin, quad);
 
-         body = new exprGroup(isMin*gmoObjConst(gmo), lin, quadpart, qnz);
+         body = new exprQuad(isMin*gmoObjConst(gmo), lin, quad);
       }
       else
       {
@@ -879,33 +1146,13 @@ CouenneProblem* GamsCouenne::setupProblem()
          for (int j = 0; j < nz; ++j)
             lin.push_back(std::pair<exprVar*, CouNumber>(prob->Var(lincolidx[j]), lincoefs[j]));
 
-         if( gmoGetEquOrderOne(gmo, i) == gmoorder_Q ) {
+         if( gmoGetEquOrderOne(gmo, i) == gmoorder_Q )
+         {
             qnz = gmoGetRowQNZOne(gmo,i);
             gmoGetRowQ(gmo, i, qcol, qrow, quadcoefs);
-            expression** quadpart = new expression*[qnz];
-
-            for( int j = 0; j < qnz; ++j )
-            {
-               assert(qcol[j] >= 0);
-               assert(qrow[j] >= 0);
-               assert(qcol[j] < gmoN(gmo));
-               assert(qrow[j] < gmoN(gmo));
-               if( qcol[j] == qrow[j] )
-               {
-                  quadcoefs[j] /= 2.0; // for some strange reason, the coefficients on the diagonal are multiplied by 2 in GMO.
-                  quadpart[j] = new exprPow(new exprClone(prob->Var(qcol[j])), new exprConst(2.0));
-               }
-               else
-               {
-                  quadpart[j] = new exprMul(new exprClone(prob->Var(qcol[j])), new exprClone(prob->Var(qrow[j])));
-               }
-               if( quadcoefs[j] == -1.0 )
-                  quadpart[j] = new exprOpp(quadpart[j]);
-               else if( quadcoefs[j] != 1.0 )
-                  quadpart[j] = new exprMul(quadpart[j], new exprConst(quadcoefs[j]));
-            }
+            getQuadElems(prob, qnz, qcol, qrow, quadcoefs, 1.0, quad);
 
-            body = new exprGroup(0, lin, quadpart, qnz);
+            body = new exprQuad(0, lin, quad);
          }
          else
          {
@@ -968,6 +1215,10 @@ CouenneProblem* GamsCouenne::setupProblem()
       }
    }
 
+   char buffer[100];
+   sprintf(buffer, "Problem for Couenne set up (%g seconds).\n", gevTimeDiffStart(gev) - starttime);
+   gevLogPChar(gev, buffer);
+
    if( (gevGetIntOpt(gev, gevInteger1) & 0x2) && (2651979 != gevGetIntOpt(gev, gevInteger1)) )
       prob->print();
    prob->initOptions(couenne_setup->options());
@@ -1008,10 +1259,13 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
    double*            constants           /**< GAMS constants pool */
 )
 {
-   bool debugoutput = (gevGetIntOpt(gev, gevInteger1) & 0x4) && (2651979 != gevGetIntOpt(gev, gevInteger1));
-#define debugout if( debugoutput ) std::clog
+   // print instructions up front, so that the loop below does not need to check for debug output
+   if( (gevGetIntOpt(gev, gevInteger1) & 0x4) && (2651979 != gevGetIntOpt(gev, gevInteger1)) )
+      printGamsInstructions(gmo, codelen, opcodes, fields, constants);
 
-   std::list<expression*> stack;
+   // operand stack, its memory is kept for the next row
+   std::vector<expression*>& stack(exprstack);
+   stack.clear();
 
    int nargs = -1;
 
@@ -1020,8 +1274,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
       GamsOpCode opcode = (GamsOpCode)opcodes[pos];
       int address = fields[pos]-1;
 
-      debugout << '\t' << GamsOpCodeName[opcode] << ": ";
-
       expression* exp = NULL;
 
       switch( opcode )
@@ -1030,36 +1282,30 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
          case nlStore:  // store row
          case nlHeader: // header
          {
-            debugout << "ignored" << std::endl;
             break;
          }
 
          case nlPushV: // push variable
          {
             address = gmoGetjSolver(gmo, address);
-            debugout << "push variable " << address << std::endl;
             exp = new exprClone(prob->Variables()[address]);
             break;
          }
 
          case nlPushI: // push constant
          {
-            debugout << "push constant " << constants[address] << std::endl;
             exp = new exprConst(constants[address]);
             break;
          }
 
          case nlPushZero: // push zero
          {
-            debugout << "push constant zero" << std::endl;
             exp = new exprConst(0.0);
             break;
          }
 
          case nlAdd: // add
          {
-            debugout << "add" << std::endl;
-
             expression* term1 = stack.back(); stack.pop_back();
             expression* term2 = stack.back(); stack.pop_back();
             exp = new exprSum(term1, term2);
@@ -1069,7 +1315,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
          case nlAddV: // add variable
          {
             address = gmoGetjSolver(gmo, address);
-            debugout << "add variable " << address << std::endl;
 
             expression* term1 = stack.back(); stack.pop_back();
             expression* term2 = new exprClone(prob->Variables()[address]);
@@ -1079,8 +1324,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
          case nlAddI: // add immediate
          {
-            debugout << "add constant " << constants[address] << std::endl;
-
             expression* term1 = stack.back(); stack.pop_back();
             expression* term2 = new exprConst(constants[address]);
             exp = new exprSum(term1, term2);
@@ -1089,7 +1332,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
          case nlSub: // minus
          {
-            debugout << "minus" << std::endl;
             expression* term1 = stack.back(); stack.pop_back();
             expression* term2 = stack.back(); stack.pop_back();
             exp = new exprSub(term2, term1);
@@ -1099,7 +1341,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
          case nlSubV: // substract variable
          {
             address = gmoGetjSolver(gmo, address);
-            debugout << "substract variable " << address << std::endl;
 
             expression* term1 = stack.back(); stack.pop_back();
             expression* term2 = new exprClone(prob->Variables()[address]);
@@ -1109,8 +1350,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
          case nlSubI: // substract immediate
          {
-            debugout << "substract constant " << constants[address] << std::endl;
-
             expression* term1 = stack.back(); stack.pop_back();
             expression* term2 = new exprConst(constants[address]);
             exp = new exprSub(term1, term2);
@@ -1119,8 +1358,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
          case nlMul: // multiply
          {
-            debugout << "multiply" << std::endl;
-
             expression* term1 = stack.back(); stack.pop_back();
             expression* term2 = stack.back(); stack.pop_back();
             exp = new exprMul(term1, term2);
@@ -1130,7 +1367,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
          case nlMulV: // multiply variable
          {
             address = gmoGetjSolver(gmo, address);
-            debugout << "multiply variable " << address << std::endl;
 
             expression* term1 = stack.back(); stack.pop_back();
             expression* term2 = new exprClone(prob->Variables()[address]);
@@ -1140,8 +1376,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
          case nlMulI: // multiply immediate
          {
-            debugout << "multiply constant " << constants[address] << std::endl;
-
             expression* term1 = stack.back(); stack.pop_back();
             if( term1->Type() == CONST )
             {
@@ -1161,8 +1395,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
          case nlMulIAdd: // multiply immediate add
          {
-            debugout << "multiply constant " << constants[address] << " and add " << std::endl;
-
             expression* term1 = stack.back(); stack.pop_back();
             term1 = new exprMul(term1, new exprConst(constants[address]));
             expression* term2 = stack.back(); stack.pop_back();
@@ -1173,8 +1405,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
          case nlDiv: // divide
          {
-            debugout << "divide" << std::endl;
-
             expression* term1 = stack.back(); stack.pop_back();
             expression* term2 = stack.back(); stack.pop_back();
             if( term2->Type() == CONST )
@@ -1187,7 +1417,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
          case nlDivV: // divide variable
          {
             address = gmoGetjSolver(gmo, address);
-            debugout << "divide variable " << address << std::endl;
 
             expression* term1 = stack.back(); stack.pop_back();
             expression* term2 = new exprClone(prob->Variables()[address]);
@@ -1200,8 +1429,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
          case nlDivI: // divide immediate
          {
-            debugout << "divide constant " << constants[address] << std::endl;
-
             expression* term1 = stack.back(); stack.pop_back();
             expression* term2 = new exprConst(constants[address]);
             exp = new exprDiv(term1, term2);
@@ -1210,8 +1437,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
          case nlUMin: // unary minus
          {
-            debugout << "negate" << std::endl;
-
             expression* term = stack.back(); stack.pop_back();
             exp = new exprOpp(term);
             break;
@@ -1220,7 +1445,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
          case nlUMinV: // unary minus variable
          {
             address = gmoGetjSolver(gmo, address);
-            debugout << "push negated variable " << address << std::endl;
 
             exp = new exprOpp(new exprClone(prob->Variables()[address]));
             break;
@@ -1229,7 +1453,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
          case nlFuncArgN: // number of function arguments
          {
             nargs = address + 1;  // undo shift by 1
-            debugout << nargs << " arguments" << std::endl;
             break;
          }
 
@@ -1242,15 +1465,11 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
                /* no break */
          case nlCallArgN :
          {
-            debugout << "call function ";
-
             switch( GamsFuncCode(address+1) )  // undo shift by 1
             {
 #if 0 /* min and max are not fully implemented in Couenne yet */
                case fnmin:
                {
-                  debugout << "min" << std::endl;
-
                   expression* term1 = stack.back(); stack.pop_back();
                   expression* term2 = stack.back(); stack.pop_back();
                   exp = new exprMin(term1, term2);
@@ -1259,8 +1478,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fnmax:
                {
-                  debugout << "max" << std::endl;
-
                   expression* term1 = stack.back(); stack.pop_back();
                   expression* term2 = stack.back(); stack.pop_back();
                   exp = new exprMax(term1, term2);
@@ -1269,8 +1486,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 #endif
                case fnsqr:
                {
-                  debugout << "square" << std::endl;
-
                   expression* term = stack.back(); stack.pop_back();
                   exp = new exprPow(term, new exprConst(2.0));
                   break;
@@ -1278,8 +1493,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fnexp:
                {
-                  debugout << "exp" << std::endl;
-
                   expression* term = stack.back(); stack.pop_back();
                   exp = new exprExp(term);
                   break;
@@ -1287,8 +1500,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fnlog:
                {
-                  debugout << "ln" << std::endl;
-
                   expression* term = stack.back(); stack.pop_back();
                   exp = new exprLog(term);
                   break;
@@ -1296,8 +1507,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fnlog10:
                {
-                  debugout << "log10 = ln * 1/ln(10)" << std::endl;
-
                   expression* term = stack.back(); stack.pop_back();
                   exp = new exprMul(new exprLog(term), new exprConst(1.0/log(10.0)));
                   break;
@@ -1305,8 +1514,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fnlog2 :
                {
-                  debugout << "log2 = ln * 1/ln(2)" << std::endl;
-
                   expression* term = stack.back(); stack.pop_back();
                   exp = new exprMul(new exprLog(term), new exprConst(1.0/log(2.0)));
                   break;
@@ -1314,8 +1521,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fnsqrt:
                {
-                  debugout << "sqrt" << std::endl;
-
                   expression* term = stack.back(); stack.pop_back();
                   exp = new exprPow(term, new exprConst(0.5));
                   break;
@@ -1323,8 +1528,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fnabs:
                {
-                  debugout << "abs" << std::endl;
-
                   expression* term = stack.back(); stack.pop_back();
                   exp = new exprAbs(term);
                   break;
@@ -1332,8 +1535,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fncos:
                {
-                  debugout << "cos" << std::endl;
-
                   expression* term = stack.back(); stack.pop_back();
                   exp = new exprCos(term);
                   break;
@@ -1341,8 +1542,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fnsin:
                {
-                  debugout << "sin" << std::endl;
-
                   expression* term = stack.back(); stack.pop_back();
                   exp = new exprSin(term);
                   break;
@@ -1351,8 +1550,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
                case fnpower:  // x ^ y
                case fnrpower: // x ^ y
                {
-                  debugout << "power(x,y) = exp(log(y)*x)" << std::endl;
-
                   expression* term1 = stack.back(); stack.pop_back();
                   expression* term2 = stack.back(); stack.pop_back();
                   if( term1->Type() == CONST )
@@ -1364,8 +1561,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fncvpower: // constant ^ x
                {
-                  debugout << "power(a,x) = exp(log(a)*x)" << std::endl;
-
                   expression* term1 = stack.back(); stack.pop_back();
                   expression* term2 = stack.back(); stack.pop_back();
 
@@ -1377,8 +1572,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fnvcpower: // x ^ constant
                {
-                  debugout << "power(x,a)" << std::endl;
-
                   expression* term1 = stack.back(); stack.pop_back();
                   expression* term2 = stack.back(); stack.pop_back();
                   assert(term1->Type() == CONST);
@@ -1400,7 +1593,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fnsignpower: // sign(x)*abs(x)^c = x * abs(x)^(c-1)
                {
-                  debugout << "signed power" << std::endl;
                   expression* term1 = stack.back(); stack.pop_back();
                   expression* term2 = stack.back(); stack.pop_back();
 
@@ -1420,14 +1612,12 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fnpi:
                {
-                  debugout << "pi" << std::endl;
                   exp = new exprConst(M_PI);
                   break;
                }
 
                case fndiv:
                {
-                  debugout << "divide" << std::endl;
                   expression* term1 = stack.back(); stack.pop_back();
                   expression* term2 = stack.back(); stack.pop_back();
                   if( term2->Type() == CONST )
@@ -1439,7 +1629,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                case fnpoly: /* univariate polynomial */
                {
-                  debugout << "univariate polynomial of degree " << nargs-2 << std::endl;
                   assert(nargs >= 0);
                   switch( nargs )
                   {
@@ -1455,22 +1644,18 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
                      default: // polynomial is at least linear
                      {
-                        std::vector<expression*> coeff(nargs-1);
-                        while( nargs > 1 )
-                        {
-                           assert(!stack.empty());
-                           coeff[nargs-2] = stack.back();
-                           stack.pop_back();
-                           --nargs;
-                        }
-                        assert(!stack.empty());
-                        expression* var = stack.back(); stack.pop_back();
-                        expression** monomials = new expression*[coeff.size()];
+                        // coefficients are the topmost nargs-1 entries of the stack, the variable is below them
+                        assert((int)stack.size() >= nargs);
+                        expression** coeff = &stack[stack.size() - (nargs-1)];
+                        expression* var = coeff[-1];
+                        int nmonomials = nargs-1;
+                        expression** monomials = new expression*[nmonomials];
                         monomials[0] = coeff[0];
                         monomials[1] = new exprMul(coeff[1], var);
-                        for( size_t i = 2; i < coeff.size(); ++i )
+                        for( int i = 2; i < nmonomials; ++i )
                            monomials[i] = new exprMul(coeff[i], new exprPow(new exprClone(var), new exprConst(static_cast<double>(i))));
-                        exp = new exprSum(monomials, static_cast<int>(coeff.size()));
+                        stack.resize(stack.size() - nargs);
+                        exp = new exprSum(monomials, nmonomials);
                      }
                   }
                   nargs = -1;
@@ -1539,7 +1724,6 @@ Couenne::expression* GamsCouenne::parseGamsInstructions(
 
    assert(stack.size() == 1);
    return stack.back();
-#undef debugout
 }
 
 void GamsCouenne::passSOSSemiCon(
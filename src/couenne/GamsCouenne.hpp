@@ -8,6 +8,7 @@
 #define GAMSCOUENNE_HPP_
 
 #include <cstdlib>
+#include <vector>
 
 typedef struct gmoRec* gmoHandle_t;
 typedef struct gevRec* gevHandle_t;
@@ -15,6 +16,7 @@ typedef struct palRec* palHandle_t;
 
 class GamsMessageHandler;
 class CbcModel;
+class OsiSolverInterface;
 namespace Couenne
 {
 class CouenneInterface;
@@ -34,6 +36,7 @@ private:
    Couenne::CouenneSetup* couenne_setup;     /**< Couenne solver application */
    GamsMessageHandler*   msghandler;         /**< COIN-OR message handler for GAMS */
    bool                  ipoptlicensed;      /**< whether a commercial Ipopt license is available */
+   std::vector<Couenne::expression*> exprstack; /**< operand stack of parseGamsInstructions, memory is reused for all rows */
 
    bool isMIP();
    Couenne::CouenneProblem* setupProblem();
@@ -50,6 +53,16 @@ private:
       Couenne::CouenneInterface* ci,         /**< Couenne interface where to add objects for SOS and semicon constraints */
       CbcModel*          cbcmodel            /**< CBC model used for B&B */
    );
+   /** tightens variable bounds by minimizing and maximizing each variable over the root linear relaxation, using several threads
+    *
+    * Returns the number of variables whose bounds have been tightened.
+    */
+   int tightenBoundsOBBT(
+      Couenne::CouenneProblem* problem,      /**< Couenne problem, the bounds in its domain are updated */
+      OsiSolverInterface* relaxation,        /**< root linear relaxation, its column bounds are updated */
+      int                nthreads,           /**< number of threads */
+      double             timelimit           /**< time limit */
+   );
 
 public:
    GamsCouenne()
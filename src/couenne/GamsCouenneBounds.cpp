@@ -0,0 +1,162 @@
+// Copyright (C) GAMS Development and others
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// Author: Stefan Vigerske
+
+#include "GamsCouenneBounds.hpp"
+#include "GamsHelper.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "gmomcc.h"
+
+/** version of file format */
+#define BOUNDS_VERSION 1
+
+uint64_t GamsCouenneBounds::fingerprint(
+   struct gmoRec*     gmo,                /**< GAMS modeling object */
+   double             cutoff              /**< cutoff on objective value, or infinity */
+)
+{
+   int n = gmoN(gmo);
+   int m = gmoM(gmo);
+
+   uint64_t h = GAMS_FNV1A_INIT;
+   h = GAMShashInt(h, n);
+   h = GAMShashInt(h, m);
+   h = GAMShashInt(h, gmoSense(gmo));
+   h = GAMShashDoubles(h, &cutoff, 1);
+
+   int* colidx  = new int[n];
+   double* coef = new double[n];
+   int* nlflag  = new int[n];
+   int* opcodes = new int[gmoNLCodeSizeMaxRow(gmo)+1];
+   int* fields  = new int[gmoNLCodeSizeMaxRow(gmo)+1];
+   int nz, nlnz;
+   int codelen;
+
+   // variables
+   gmoGetVarLower(gmo, coef);
+   h = GAMShashDoubles(h, coef, n);
+   gmoGetVarUpper(gmo, coef);
+   h = GAMShashDoubles(h, coef, n);
+   for( int j = 0; j < n; ++j )
+      h = GAMShashInt(h, gmoGetVarTypeOne(gmo, j));
+
+   // constants pool
+   h = GAMShashDoubles(h, (double*)gmoPPool(gmo), gmoNLConst(gmo));
+
+   // objective
+   gmoGetObjSparse(gmo, colidx, coef, nlflag, &nz, &nlnz);
+   for( int k = 0; k < nz; ++k )
+   {
+      h = GAMShashInt(h, colidx[k]);
+      h = GAMShashInt(h, nlflag[k]);
+      if( !nlflag[k] )
+         h = GAMShashDoubles(h, &coef[k], 1);
+   }
+   double objconst = gmoObjConst(gmo);
+   h = GAMShashDoubles(h, &objconst, 1);
+   if( nlnz > 0 )
+   {
+      gmoDirtyGetObjFNLInstr(gmo, &codelen, opcodes, fields);
+      for( int k = 0; k < codelen; ++k )
+      {
+         h = GAMShashInt(h, opcodes[k]);
+         h = GAMShashInt(h, fields[k]);
+      }
+   }
+
+   // equations
+   for( int i = 0; i < m; ++i )
+   {
+      h = GAMShashInt(h, gmoGetEquTypeOne(gmo, i));
+      double rhs = gmoGetRhsOne(gmo, i);
+      h = GAMShashDoubles(h, &rhs, 1);
+
+      gmoGetRowSparse(gmo, i, colidx, coef, nlflag, &nz, &nlnz);
+      for( int k = 0; k < nz; ++k )
+      {
+         h = GAMShashInt(h, colidx[k]);
+         h = GAMShashInt(h, nlflag[k]);
+         if( !nlflag[k] )
+            h = GAMShashDoubles(h, &coef[k], 1);
+      }
+
+      if( nlnz > 0 )
+      {
+         gmoDirtyGetRowFNLInstr(gmo, i, &codelen, opcodes, fields);
+         for( int k = 0; k < codelen; ++k )
+         {
+            h = GAMShashInt(h, opcodes[k]);
+            h = GAMShashInt(h, fields[k]);
+         }
+      }
+   }
+
+   delete[] colidx;
+   delete[] coef;
+   delete[] nlflag;
+   delete[] opcodes;
+   delete[] fields;
+
+   return h;
+}
+
+bool GamsCouenneBounds::read(
+   struct gmoRec*     gmo,                /**< GAMS modeling object */
+   double             cutoff,             /**< cutoff on objective value, or infinity */
+   const char*        filename            /**< name of file */
+)
+{
+   FILE* f = fopen(filename, "r");
+   if( f == NULL )
+      return false;
+
+   int version;
+   uint64_t fp;
+   int n;
+   if( fscanf(f, "GAMSLINKS_BOUNDS %d %" SCNx64 " %d", &version, &fp, &n) != 3 || version != BOUNDS_VERSION
+      || fp != fingerprint(gmo, cutoff) || n != gmoN(gmo) )
+   {
+      fclose(f);
+      return false;
+   }
+
+   lb.resize(n);
+   ub.resize(n);
+   int j;
+   for( j = 0; j < n; ++j )
+      if( fscanf(f, "%lf %lf", &lb[j], &ub[j]) != 2 )
+         break;
+
+   fclose(f);
+
+   if( j < n )
+   {
+      lb.clear();
+      ub.clear();
+      return false;
+   }
+
+   return true;
+}
+
+bool GamsCouenneBounds::write(
+   struct gmoRec*     gmo,                /**< GAMS modeling object */
+   double             cutoff,             /**< cutoff on objective value, or infinity */
+   const char*        filename            /**< name of file */
+) const
+{
+   FILE* f = fopen(filename, "w");
+   if( f == NULL )
+      return false;
+
+   fprintf(f, "GAMSLINKS_BOUNDS %d %" PRIx64 " %d\n", BOUNDS_VERSION, fingerprint(gmo, cutoff), (int)lb.size());
+   for( size_t j = 0; j < lb.size(); ++j )
+      fprintf(f, "%.17g %.17g\n", lb[j], ub[j]);
+
+   return fclose(f) == 0;
+}
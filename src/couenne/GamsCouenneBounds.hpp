@@ -0,0 +1,52 @@
+// Copyright (C) GAMS Development and others
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// Author: Stefan Vigerske
+
+#ifndef GAMSCOUENNEBOUNDS_HPP_
+#define GAMSCOUENNEBOUNDS_HPP_
+
+#include <cstdint>
+#include <vector>
+
+struct gmoRec;
+
+/** tightened bounds on the variables of a model that can be stored in a file and reused when solving the same model again
+ *
+ * A file is accepted only if the fingerprint of the model matches.
+ * The fingerprint covers the problem data that bound tightening depends on:
+ * variable types and bounds, equation types and right-hand sides, linear coefficients, nonlinear instructions and constants, and the cutoff.
+ */
+class GamsCouenneBounds
+{
+private:
+   /** computes a fingerprint of the model */
+   static uint64_t fingerprint(
+      struct gmoRec*     gmo,                /**< GAMS modeling object */
+      double             cutoff              /**< cutoff on objective value, or infinity */
+   );
+
+public:
+   std::vector<double>   lb;                 /**< lower bounds on variables */
+   std::vector<double>   ub;                 /**< upper bounds on variables */
+
+   /** reads bounds from a file
+    *
+    * Returns false if the file cannot be read or is for another model.
+    */
+   bool read(
+      struct gmoRec*     gmo,                /**< GAMS modeling object */
+      double             cutoff,             /**< cutoff on objective value, or infinity */
+      const char*        filename            /**< name of file */
+   );
+
+   /** writes bounds to a file */
+   bool write(
+      struct gmoRec*     gmo,                /**< GAMS modeling object */
+      double             cutoff,             /**< cutoff on objective value, or infinity */
+      const char*        filename            /**< name of file */
+   ) const;
+};
+
+#endif /* GAMSCOUENNEBOUNDS_HPP_ */
@@ -49,6 +49,20 @@ int main(int argc, char** argv)
       "cpu", "CPU time", "wall", "Wall-clock time",
       "");
 
+   regoptions->SetRegisteringCategory("Couenne options", Bonmin::RegisteredOptions::CouenneCategory);
+   regoptions->AddStringOption2("obbt_prepass",
+      "Whether to tighten variable bounds by optimality-based bound tightening on the root linear relaxation before branch-and-bound",
+      "no",
+      "no", "", "yes", "",
+      "The LPs that minimize and maximize each variable are distributed onto the number of threads given by the GAMS option threads.");
+
+   regoptions->AddStringOption1("bounds_file",
+      "Name of file for reusing tightened variable bounds between runs on the same model.",
+      "", "*",
+      "If the file exists and has been written for a model with the same data, then its bounds are intersected with the variable bounds before solving. "
+      "In this case, the OBBT pre-pass is skipped. "
+      "After Couenne has been initialized, the tightened bounds are written to the file.");
+
    const Bonmin::RegisteredOptions::RegOptionsList& optionlist(regoptions->RegisteredOptionsList());
 
    // options sorted by category
@@ -7,14 +7,23 @@
 #include "GamsIpopt.hpp"
 #include "GamsNLP.hpp"
 #include "GamsJournal.hpp"
+#include "GamsLinearSolver.hpp"
 
 #include "IpoptConfig.h"
 #include "IpSolveStatistics.hpp"
+#include "IpAlgTypes.hpp"
 
 #include <cstdio>
 #include <cstring>
 #include <cassert>
 #include <climits>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
 
 // GAMS
 #include "gmomcc.h"
@@ -53,6 +62,80 @@ void GamsIpopt::setupIpopt()
       "no",
       "no", "", "yes", "",
       "This option allows to obtain the most feasible solution found by Ipopt during the iteration process, if it stops at a (locally) infeasible solution, due to a limit (time, iterations, ...), or with a failure in the restoration phase.");
+   ipopt->RegOptions()->AddStringOption2("eval_profile",
+      "Switch to enable counting and timing of function evaluations.",
+      "no",
+      "no", "", "yes", "",
+      "If enabled, a table with the number of calls and the wall-clock and CPU time spent in each kind of function evaluation is printed at the end of the solve. "
+      "It also includes a histogram of the time per call and compares the time spent in function evaluations with the time spent in the linear solver. "
+      "Enabling this option also enables option timing_statistics.");
+   ipopt->RegOptions()->AddStringOption1("eval_profile_json",
+      "Name of file to write function evaluation profile to in JSON format.",
+      "",
+      "*", "Any acceptable standard file name",
+      "Only used if eval_profile is enabled.");
+
+   ipopt->RegOptions()->SetRegisteringCategory("Multistart");
+   ipopt->RegOptions()->AddLowerBoundedIntegerOption("multistart",
+      "Number of starting points for multistart.",
+      0, 0,
+      "If positive, then Ipopt is run from the given number of starting points concurrently, using as many threads as specified by the GAMS threads option. "
+      "The first starting point is the initial point given by GAMS, the others are sampled within the variable bounds. "
+      "Afterwards, a summary of all runs is printed and the final solve is started from the best feasible local optimum that was found.");
+   ipopt->RegOptions()->AddStringOption2("multistart_points",
+      "Method to sample starting points for multistart.",
+      "random",
+      "random", "uniformly distributed random points",
+      "latin-hypercube", "space-filling points by Latin hypercube sampling");
+   ipopt->RegOptions()->AddLowerBoundedNumberOption("multistart_radius",
+      "Maximal distance of sampled starting points from the initial point in each coordinate.",
+      0.0, true, 10.0,
+      "Starting points are sampled within the variable bounds intersected with a box of this radius around the initial point (projected onto the bounds). "
+      "This also limits the sampling range for variables without bounds.");
+   ipopt->RegOptions()->AddLowerBoundedIntegerOption("multistart_seed",
+      "Seed for the random number generator used to sample starting points.",
+      0, 0);
+
+   ipopt->RegOptions()->SetRegisteringCategory("Linear Solver");
+   ipopt->RegOptions()->AddStringOption3("linear_solver_selection",
+      "Method to choose the linear solver.",
+      "fixed",
+      "fixed", "use linear solver as specified by option linear_solver",
+      "auto", "choose linear solver and ordering from size and density of the KKT system and the number of threads",
+      "probe", "run a few iterations with each available linear solver and use the one that spent least time",
+      "With settings auto and probe, the value of option linear_solver is overwritten. "
+      "With setting auto, the HSL solvers are considered only for IpoptH. "
+      "Setting probe can pay off if the model is large and is solved many times, e.g., with GUSS.");
+
+   ipopt->RegOptions()->SetRegisteringCategory("NLP");
+   ipopt->RegOptions()->AddStringOption2("presolve",
+      "Switch to enable presolving the NLP before passing it to Ipopt.",
+      "no",
+      "no", "", "yes", "",
+      "If enabled, then fixed variables, empty rows, and linear inequalities that cannot be violated within the variable bounds are removed, "
+      "linear constraints in a single variable are turned into variable bounds, "
+      "and free variables that appear only linearly are substituted out via linear equations in two variables. "
+      "Primal and dual values for the removed variables and equations are recovered after the solve. "
+      "With presolve enabled, Ipopt cannot reuse its data structures in a warmstart.");
+   ipopt->RegOptions()->AddStringOption2("parallel_eval",
+      "Switch to evaluate nonlinear equations and their gradients in parallel.",
+      "no",
+      "no", "", "yes", "",
+      "If enabled, then the GAMS instructions of nonlinear equations are compiled into a representation that can be evaluated by several threads at once. "
+      "The number of threads is given by the GAMS threads option. "
+      "Equations with functions that are not supported, or whose values or gradients at the starting point differ from those computed by GAMS, are still evaluated by GAMS. "
+      "At other points, values and gradients may differ from those computed by GAMS due to rounding. "
+      "Requires that the Ipopt link has been built with OpenMP, otherwise evaluation is sequential.");
+
+   ipopt->RegOptions()->SetRegisteringCategory("Warm Start");
+   ipopt->RegOptions()->AddStringOption2("parametric",
+      "Switch to enable a parametric mode for sequences of solves of modified problems, e.g., with GUSS.",
+      "no",
+      "no", "", "yes", "",
+      "If enabled, then before a re-solve of a modified problem, the KKT conditions are checked at the previous locally optimal solution. "
+      "If they still hold, e.g., because only parameters of inactive constraints changed, then this solution is returned without calling Ipopt. "
+      "If the previous solution is still feasible for all constraints and bounds that were inactive, then Ipopt is warmstarted from this solution with a small initial barrier parameter and small pushes of the starting point into the interior. "
+      "If the active set changes, then the re-solve starts from the initial point given by GAMS.");
 
    // change some option defaults
    ipopt->Options()->clear();
@@ -72,6 +155,7 @@ void GamsIpopt::setupIpopt()
    }
 
    warmstart = false;
+   canwarmstart = false;
 }
 
 int GamsIpopt::readyAPI(
@@ -160,9 +244,6 @@ int GamsIpopt::readyAPI(
       // if linear constraints, then Ipopt can skip reevaluating the Jacobian
       ipopt->Options()->SetStringValue("jac_c_constant", "yes", true, true);
       ipopt->Options()->SetStringValue("jac_d_constant", "yes", true, true);
-      // if also quadratic objective, then Ipopt can skip reevaluating the Hessian, too
-      if( gmoModelType(gmo) == gmoProc_qcp || gmoModelType(gmo) == gmoProc_rmiqcp )
-         ipopt->Options()->SetStringValue("hessian_constant", "yes", true, true);
    }
    else
    {
@@ -185,6 +266,20 @@ int GamsIpopt::readyAPI(
       if( jac_d_constant )
          ipopt->Options()->SetStringValue("jac_d_constant", "yes", true, true);
    }
+
+   // for quadratic models, let GMO recognize quadratic functions, so that the Hessian can be assembled from their coefficients
+   // this is done once here, as switching Q mode requires GMO to analyse the instructions again,
+   // and only after the nonlinear rows have been counted above, since GMO does not count quadratic rows as nonlinear in Q mode
+   if( (gmoModelType(gmo) == gmoProc_qcp || gmoModelType(gmo) == gmoProc_rmiqcp || gmoModelType(gmo) == gmoProc_miqcp) &&
+      (gmoNLNZ(gmo) > 0 || gmoObjNLNZ(gmo) > 0) )
+   {
+      bool linearcons = gmoNLM(gmo) == 0;
+      gmoUseQSet(gmo, 1);
+      // if linear constraints and quadratic objective, then Ipopt can skip reevaluating the Hessian, too
+      if( linearcons && gmoGetObjOrder(gmo) <= gmoorder_Q )
+         ipopt->Options()->SetStringValue("hessian_constant", "yes", true, true);
+   }
+
    if( gmoSense(gmo) == gmoObj_Max )
       ipopt->Options()->SetNumericValue("obj_scaling_factor", -1.0, true, true);
 
@@ -225,11 +320,356 @@ int GamsIpopt::readyAPI(
       }
    }
 
+   std::string linsolselect;
+   ipopt->Options()->GetStringValue("linear_solver_selection", linsolselect, "");
+   if( linsolselect == "auto" )
+   {
+      int nnzhess = 0;
+      ipopt->Options()->GetStringValue("hessian_approximation", hess_approx, "");
+      if( hess_approx == "exact" )
+         nnzhess = gmoHessLagNz(gmo);
+      std::string msg = GAMSselectLinearSolver(*ipopt->Options(), *ipopt->RegOptions(), ipoptlicensed,
+         gmoN(gmo), gmoM(gmo), gmoNZ64(gmo), nnzhess, gevThreads(gev));
+      gevLog(gev, msg.c_str());
+   }
+
    ipopt->Options()->GetBoolValue("report_mininfeas_solution", nlp->reportmininfeas, "");
+   ipopt->Options()->GetBoolValue("presolve", nlp->presolve, "");
+   ipopt->Options()->GetBoolValue("parallel_eval", nlp->paralleleval, "");
+
+   bool parametric;
+   ipopt->Options()->GetBoolValue("parametric", parametric, "");
+   lastsol = GamsNLPSolution();
+   nlp->keepsol = parametric ? &lastsol : NULL;
+
+   ipopt->Options()->GetBoolValue("eval_profile", nlp->profile, "");
+   if( nlp->profile )
+      ipopt->Options()->SetStringValue("timing_statistics", "yes");
 
    return 0;
 }
 
+SmartPtr<IpoptApplication> GamsIpopt::createQuietIpopt()
+{
+   // take over option values from main Ipopt instance, but do not print anything
+   SmartPtr<IpoptApplication> app = new IpoptApplication(false);
+   *app->Options() = *ipopt->Options();
+   app->Options()->SetRegisteredOptions(app->RegOptions());
+   app->Options()->SetJournalist(app->Jnlst());
+   app->Options()->SetStringValue("output_file", "");
+   app->Options()->SetStringValue("print_user_options", "no");
+   app->Options()->SetStringValue("print_timing_statistics", "no");
+   app->Options()->SetStringValue("warm_start_same_structure", "no");
+   app->Options()->SetNumericValue("max_wall_time", std::max(remainingTime(), 1e-3));
+
+   return app;
+}
+
+void GamsIpopt::probeLinearSolver()
+{
+   char buffer[GMS_SSSIZE];
+
+   // candidates are all linear solvers that are available and that we are allowed to use
+   std::vector<std::string> candidates;
+   for( auto& solver : GAMSavailableLinearSolvers(*ipopt->RegOptions()) )
+   {
+      // skip MA77, as it works out-of-core
+      bool ishsl = solver.compare(0, 2, "ma") == 0;
+      if( (ishsl == ipoptlicensed && solver != "ma77") || solver == "mumps" )
+         candidates.push_back(solver);
+   }
+
+   if( candidates.size() < 2 )
+      return;
+
+   gevLog(gev, "\nProbing linear solvers:");
+
+   // run a few iterations with each candidate and measure the time spent in the linear solver
+   // the first iterations include the symbolic factorization, which is often the most expensive part for large models
+   std::string bestsolver;
+   double besttime = 0.0;
+   for( auto& solver : candidates )
+   {
+      if( remainingTime() <= 0.0 )
+      {
+         gevLog(gev, "  time limit reached");
+         break;
+      }
+
+      SmartPtr<IpoptApplication> app = createQuietIpopt();
+      app->Options()->SetStringValue("linear_solver", solver);
+      app->Options()->SetIntegerValue("max_iter", 3);
+      app->Options()->SetStringValue("timing_statistics", "yes");
+
+      GamsNLPSolution sol;
+      SmartPtr<GamsNLP> probenlp = new GamsNLP(gmo);
+      probenlp->div_iter_tol = nlp->div_iter_tol;
+      probenlp->conviol_tol = nlp->conviol_tol;
+      probenlp->compl_tol = nlp->compl_tol;
+      probenlp->profile = true;
+      probenlp->presolve = nlp->presolve;
+      probenlp->storesol = &sol;
+
+      try
+      {
+         if( app->Initialize("", false) == Solve_Succeeded )
+            app->OptimizeTNLP(GetRawPtr(probenlp));
+      }
+      catch( ... )
+      {
+         sol.valid = false;
+      }
+
+      if( !sol.valid )
+      {
+         sprintf(buffer, "  %-12s failed", solver.c_str());
+         gevLog(gev, buffer);
+         continue;
+      }
+
+      double time = probenlp->getLinearSolverTime();
+      sprintf(buffer, "  %-12s %9.3fs", solver.c_str(), time);
+      gevLog(gev, buffer);
+
+      if( bestsolver.empty() || time < besttime )
+      {
+         bestsolver = solver;
+         besttime = time;
+      }
+   }
+
+   if( bestsolver.empty() )
+   {
+      gevLog(gev, "All probes failed. Keeping linear solver as it is.\n");
+      return;
+   }
+
+   sprintf(buffer, "Linear solver %s selected: fastest in probe.\n", bestsolver.c_str());
+   gevLog(gev, buffer);
+   ipopt->Options()->SetStringValue("linear_solver", bestsolver);
+}
+
+/** result of a single run of the multistart */
+struct MultistartRun
+{
+   GamsNLPSolution       sol;                /**< solution as passed to finalize_solution */
+   ApplicationReturnStatus status;           /**< Ipopt return status */
+   int                   iterations;         /**< number of iterations */
+   double                time;               /**< wall-clock time */
+
+   MultistartRun()
+   : status(Internal_Error),
+     iterations(0),
+     time(0.0)
+   { }
+};
+
+/** gives a short description of an Ipopt solver return status for the multistart summary */
+static
+const char* solverReturnDescription(
+   SolverReturn       status
+)
+{
+   switch( status )
+   {
+      case SUCCESS:
+         return "locally optimal";
+      case STOP_AT_ACCEPTABLE_POINT:
+         return "acceptable";
+      case FEASIBLE_POINT_FOUND:
+         return "feasible";
+      case LOCAL_INFEASIBILITY:
+         return "locally infeasible";
+      case DIVERGING_ITERATES:
+         return "diverging";
+      case MAXITER_EXCEEDED:
+         return "iteration limit";
+      case CPUTIME_EXCEEDED:
+      case WALLTIME_EXCEEDED:
+         return "time limit";
+      case STOP_AT_TINY_STEP:
+         return "tiny step";
+      case RESTORATION_FAILURE:
+         return "restoration failed";
+      case USER_REQUESTED_STOP:
+         return "interrupted";
+      default:
+         return "error";
+   }
+}
+
+bool GamsIpopt::multistart(
+   int                nstarts,
+   GamsNLPSolution&   best
+)
+{
+   char buffer[GMS_SSSIZE];
+   int n = gmoN(gmo);
+
+   assert(nstarts > 0);
+
+   std::string pointsmethod;
+   double radius;
+   int seed;
+   ipopt->Options()->GetStringValue("multistart_points", pointsmethod, "");
+   ipopt->Options()->GetNumericValue("multistart_radius", radius, "");
+   ipopt->Options()->GetIntegerValue("multistart_seed", seed, "");
+
+   int nthreads = std::max(1, std::min(gevThreads(gev), nstarts));
+
+   sprintf(buffer, "\nMultistart: solving from %d starting points using %d threads.\n", nstarts, nthreads);
+   gevLogStatPChar(gev, buffer);
+
+   // sampling box for each variable: bounds intersected with a box around the initial point projected onto the bounds
+   std::vector<double> x0(n);
+   std::vector<double> boxlo(n);
+   std::vector<double> boxup(n);
+   gmoGetVarL(gmo, x0.data());
+   gmoGetVarLower(gmo, boxlo.data());
+   gmoGetVarUpper(gmo, boxup.data());
+   for( int j = 0; j < n; ++j )
+   {
+      double xc = std::min(std::max(x0[j], boxlo[j]), boxup[j]);
+      boxlo[j] = std::max(boxlo[j], xc - radius);
+      boxup[j] = std::min(boxup[j], xc + radius);
+   }
+
+   // first starting point is the one from GAMS, others are sampled
+   std::vector<std::vector<double> > points(nstarts, x0);
+   std::mt19937 rng(seed);
+   std::uniform_real_distribution<double> unif(0.0, 1.0);
+   if( pointsmethod == "latin-hypercube" && nstarts > 1 )
+   {
+      // split range of each variable into nstarts-1 strata and sample each stratum by exactly one point
+      std::vector<int> perm(nstarts-1);
+      for( int j = 0; j < n; ++j )
+      {
+         std::iota(perm.begin(), perm.end(), 0);
+         std::shuffle(perm.begin(), perm.end(), rng);
+         for( int k = 1; k < nstarts; ++k )
+            points[k][j] = boxlo[j] + (perm[k-1] + unif(rng)) / (nstarts-1) * (boxup[j] - boxlo[j]);
+      }
+   }
+   else
+   {
+      for( int k = 1; k < nstarts; ++k )
+         for( int j = 0; j < n; ++j )
+            points[k][j] = boxlo[j] + unif(rng) * (boxup[j] - boxlo[j]);
+   }
+
+   // setup an Ipopt instance and an NLP for each start
+   // GMO evaluations cannot run concurrently, so the NLPs serialize their access to GMO
+   // nonlinear equations are evaluated without GMO where possible, by an evaluator that is shared by all NLPs,
+   // so that only objective, Hessian, and unsupported equations need GMO
+   GamsNLPSharedGmo sharedgmo;
+   std::vector<SmartPtr<IpoptApplication> > apps(nstarts);
+   std::vector<SmartPtr<GamsNLP> > nlps(nstarts);
+   std::vector<MultistartRun> runs(nstarts);
+   for( int k = 0; k < nstarts; ++k )
+   {
+      apps[k] = createQuietIpopt();
+      apps[k]->Options()->SetStringValue("warm_start_init_point", "no");
+      apps[k]->Initialize("", false);
+
+      nlps[k] = new GamsNLP(gmo);
+      nlps[k]->div_iter_tol = nlp->div_iter_tol;
+      nlps[k]->conviol_tol = nlp->conviol_tol;
+      nlps[k]->compl_tol = nlp->compl_tol;
+      nlps[k]->sharedgmo = &sharedgmo;
+      nlps[k]->paralleleval = true;
+      nlps[k]->initx = points[k].data();
+      nlps[k]->storesol = &runs[k].sol;
+   }
+
+   std::atomic<int> nextstart(0);
+   auto worker = [&]()
+   {
+      int k;
+      // std::thread does not inherit the OpenMP thread count of the main thread, so set it for each worker
+      GAMSsetNumThreadsLocal(1);
+      while( (k = nextstart++) < nstarts )
+      {
+         // the starts share the time limit, so give each the time that is left when it begins
+         double remaining = remainingTime();
+         if( remaining <= 0.0 )
+         {
+            runs[k].status = Maximum_WallTime_Exceeded;
+            continue;
+         }
+         apps[k]->Options()->SetNumericValue("max_wall_time", remaining);
+
+         std::chrono::steady_clock::time_point starttime = std::chrono::steady_clock::now();
+         try
+         {
+            runs[k].status = apps[k]->OptimizeTNLP(GetRawPtr(nlps[k]));
+         }
+         catch( ... )
+         {
+            runs[k].status = Unrecoverable_Exception;
+         }
+         runs[k].time = std::chrono::duration<double>(std::chrono::steady_clock::now() - starttime).count();
+
+         SmartPtr<SolveStatistics> solvestat = apps[k]->Statistics();
+         if( IsValid(solvestat) )
+            runs[k].iterations = solvestat->IterationCount();
+      }
+   };
+
+   // run the starts in parallel, each thread using a single thread in linear algebra
+   GAMSsetNumThreads(gev, 1);
+   std::vector<std::thread> threads;
+   for( int t = 1; t < nthreads; ++t )
+      threads.emplace_back(worker);
+   worker();
+   for( auto& t : threads )
+      t.join();
+
+   // pick best feasible point, preferring local optima
+   double objsense = gmoSense(gmo) == gmoObj_Max ? -1.0 : 1.0;
+   int bestk = -1;
+   bool bestisopt = false;
+   for( int k = 0; k < nstarts; ++k )
+   {
+      const GamsNLPSolution& sol = runs[k].sol;
+      if( !sol.valid || sol.conviol > nlp->conviol_tol || sol.status == LOCAL_INFEASIBILITY || sol.status == DIVERGING_ITERATES )
+         continue;
+      bool isopt = sol.status == SUCCESS || sol.status == STOP_AT_ACCEPTABLE_POINT;
+      if( bestk < 0 || (isopt && !bestisopt) || (isopt == bestisopt && objsense * sol.objval < objsense * runs[bestk].sol.objval) )
+      {
+         bestk = k;
+         bestisopt = isopt;
+      }
+   }
+
+   // print summary
+   gevLogStat(gev, "");
+   gevLogStat(gev, " Start       Objective  Constr.viol.   Iter.     Time  Status");
+   for( int k = 0; k < nstarts; ++k )
+   {
+      const GamsNLPSolution& sol = runs[k].sol;
+      if( sol.valid )
+         sprintf(buffer, "%c%5d  %14.7e  %12.5e  %6d  %7.2fs  %s", k == bestk ? '*' : ' ', k,
+            sol.objval, sol.conviol, runs[k].iterations, runs[k].time, solverReturnDescription(sol.status));
+      else
+         sprintf(buffer, " %5d  %14s  %12s  %6d  %7.2fs  error (return code %d)", k,
+            "-", "-", runs[k].iterations, runs[k].time, (int)runs[k].status);
+      gevLogStat(gev, buffer);
+   }
+
+   if( bestk < 0 )
+   {
+      gevLogStat(gev, "\nMultistart found no feasible point. Continue with solve from initial point.\n");
+      return false;
+   }
+
+   sprintf(buffer, "\nMultistart: best point found from start %d. Continue with solve from this point.\n", bestk);
+   gevLogStatPChar(gev, buffer);
+
+   best = runs[bestk].sol;
+
+   return true;
+}
+
 int GamsIpopt::callSolver()
 {
    assert(gmo != NULL);
@@ -249,9 +689,13 @@ int GamsIpopt::callSolver()
       return 0;
    }
 
+   // probing, multistart, and final solve share the time limit
+   solvestart = std::chrono::steady_clock::now();
+   timelimit = gevGetDblOpt(gev, gevResLim);
+
    // process options and setup NLP
    ipopt->Options()->SetIntegerValue("max_iter", gevGetIntOpt(gev, gevIterLim), true, true);
-   ipopt->Options()->SetNumericValue("max_wall_time", gevGetDblOpt(gev, gevResLim), true, true);
+   ipopt->Options()->SetNumericValue("max_wall_time", timelimit, true, true);
 
    double ipoptinf;
    ipopt->Options()->GetNumericValue("nlp_lower_bound_inf", ipoptinf, "");
@@ -275,37 +719,163 @@ int GamsIpopt::callSolver()
             boundtype[i] |= 1u;
          if( gmoGetVarUpperOne(gmo, i) != gmoPinf(gmo) )
             boundtype[i] |= 2u;
+         if( gmoGetVarLowerOne(gmo, i) == gmoGetVarUpperOne(gmo, i) )
+            boundtype[i] |= 4u;
       }
    }
 
+   // in parametric mode, check whether previous solution is still optimal, or decide how to warmstart from it
+   std::chrono::steady_clock::time_point callstart = std::chrono::steady_clock::now();
+   SmartPtr<OptionsList> savedoptions;
+   if( warmstart && nlp->keepsol != NULL && lastsol.valid )
+   {
+      double tol;
+      std::vector<double> activity;
+      ipopt->Options()->GetNumericValue("tol", tol, "");
+
+      int rc = nlp->checkKKTPoint(lastsol, tol, activity);
+      if( rc == 1 )
+      {
+         gevLog(gev, "Parametric: solution of previous solve remains locally optimal.");
+         nlp->reportKKTPoint(lastsol, activity);
+         gmoSetHeadnTail(gmo, gmoHresused, std::chrono::duration<double>(std::chrono::steady_clock::now() - callstart).count());
+         gmoSetHeadnTail(gmo, gmoHiterused, 0);
+         if( gmoModelType(gmo) == gmoProc_cns )
+            gmoModelStatSet(gmo, gmoModelStat_Solved);
+         return 0;
+      }
+
+      savedoptions = new OptionsList(*ipopt->Options());
+      if( rc == 0 )
+      {
+         // active set is likely to stay, so start close to the previous solution
+         gevLog(gev, "Parametric: warmstart from solution of previous solve.");
+         nlp->initx = lastsol.x.data();
+         nlp->initzl = lastsol.zl.data();
+         nlp->initzu = lastsol.zu.data();
+         nlp->initlambda = lastsol.lambda.data();
+         ipopt->Options()->SetStringValue("warm_start_init_point", "yes");
+         ipopt->Options()->SetNumericValue("mu_init", std::max(1e-9, tol));
+         ipopt->Options()->SetNumericValue("warm_start_bound_push", 1e-9);
+         ipopt->Options()->SetNumericValue("warm_start_bound_frac", 1e-9);
+         ipopt->Options()->SetNumericValue("warm_start_slack_bound_push", 1e-9);
+         ipopt->Options()->SetNumericValue("warm_start_slack_bound_frac", 1e-9);
+         ipopt->Options()->SetNumericValue("warm_start_mult_bound_push", 1e-9);
+      }
+      else
+      {
+         gevLog(gev, "Parametric: active set changes, so start from initial point.");
+         ipopt->Options()->SetStringValue("warm_start_init_point", "no");
+      }
+   }
+
+   // choose linear solver by probing, if requested
+   // do this only for the first solve, since Ipopt cannot change the linear solver in a warmstart
+   std::string linsolselect;
+   ipopt->Options()->GetStringValue("linear_solver_selection", linsolselect, "");
+   // number of threads in linear algebra
+   int nthreads = gevGetIntOpt(gev, gevThreadsRaw) != 0 ? gevThreads(gev) : 1;
+   double extratime = std::chrono::duration<double>(std::chrono::steady_clock::now() - callstart).count();
+   if( linsolselect == "probe" && !warmstart )
+   {
+      std::chrono::steady_clock::time_point starttime = std::chrono::steady_clock::now();
+      GAMSsetNumThreads(gev, nthreads);
+      probeLinearSolver();
+      extratime += std::chrono::duration<double>(std::chrono::steady_clock::now() - starttime).count();
+   }
+
+   // run multistart, if requested and not warmstarting in parametric mode, and start the final solve from the best point found
+   int nstarts;
+   GamsNLPSolution multistartsol;
+   ipopt->Options()->GetIntegerValue("multistart", nstarts, "");
+   if( nstarts > 0 && nlp->initx == NULL )
+   {
+      std::chrono::steady_clock::time_point starttime = std::chrono::steady_clock::now();
+      if( multistart(nstarts, multistartsol) )
+      {
+         nlp->initx = multistartsol.x.data();
+         nlp->initzl = multistartsol.zl.data();
+         nlp->initzu = multistartsol.zu.data();
+         nlp->initlambda = multistartsol.lambda.data();
+         if( IsNull(savedoptions) )
+            savedoptions = new OptionsList(*ipopt->Options());
+         ipopt->Options()->SetStringValue("warm_start_init_point", "yes");
+      }
+      extratime += std::chrono::duration<double>(std::chrono::steady_clock::now() - starttime).count();
+   }
+
    // set number of threads in linear algebra
-   if( gevGetIntOpt(gev, gevThreadsRaw) != 0 )
-      GAMSsetNumThreads(gev, gevThreads(gev));
-   else
-      GAMSsetNumThreads(gev, 1);
+   GAMSsetNumThreads(gev, nthreads);
+
+   // leave the final solve only the time that probing and multistart did not use
+   ipopt->Options()->SetNumericValue("max_wall_time", std::max(remainingTime(), 1e-3), true, true);
 
    // solve NLP
    ApplicationReturnStatus status;
    try
    {
-      if( !warmstart )
-         status = ipopt->OptimizeTNLP(GetRawPtr(nlp));
+      if( warmstart && canwarmstart )
+      {
+         // Ipopt rejects the warmstart if the problem dimensions changed in a way that modifyProblem did not notice
+         // it reports this as an unrecoverable exception, so retry with new data structures in that case
+         bool invalidwarmstart = false;
+         try
+         {
+            status = ipopt->ReOptimizeTNLP(GetRawPtr(nlp));
+            invalidwarmstart = status == Unrecoverable_Exception;
+         }
+         catch( INVALID_WARMSTART& )
+         {
+            invalidwarmstart = true;
+         }
+         if( invalidwarmstart )
+         {
+            gevLog(gev, "Warmstart with previous data structures failed. Ipopt will rebuild its data structures.");
+            ipopt->Options()->SetStringValue("warm_start_same_structure", "no");
+            status = ipopt->OptimizeTNLP(GetRawPtr(nlp));
+         }
+      }
       else
-         status = ipopt->ReOptimizeTNLP(GetRawPtr(nlp));
+      {
+         // if the previous solve failed before Ipopt set up its data structures, then we have to start from scratch
+         if( warmstart )
+            ipopt->Options()->SetStringValue("warm_start_same_structure", "no");
+         status = ipopt->OptimizeTNLP(GetRawPtr(nlp));
+      }
    }
    catch( IpoptException& e )
    {
       status = Unrecoverable_Exception;
       gevLogStat(gev, e.Message().c_str());
    }
+   canwarmstart = false;
+
+   // forget about starting point from multistart or parametric mode
+   nlp->initx = NULL;
+   nlp->initzl = NULL;
+   nlp->initzu = NULL;
+   nlp->initlambda = NULL;
+   if( IsValid(savedoptions) )
+      *ipopt->Options() = *savedoptions;
 
    SmartPtr<SolveStatistics> solvestat = ipopt->Statistics();
    if( IsValid(solvestat) )
    {
-      gmoSetHeadnTail(gmo, gmoHresused, solvestat->TotalWallclockTime());
+      gmoSetHeadnTail(gmo, gmoHresused, solvestat->TotalWallclockTime() + extratime);
       gmoSetHeadnTail(gmo, gmoHiterused, solvestat->IterationCount());
    }
 
+   // evaluation counts are of interest for debugging only
+   int printlevel;
+   ipopt->Options()->GetIntegerValue("print_level", printlevel, "");
+   nlp->printEvalStatistics(printlevel > J_ITERSUMMARY);
+   if( nlp->profile )
+   {
+      std::string jsonfile;
+      ipopt->Options()->GetStringValue("eval_profile_json", jsonfile, "");
+      nlp->printEvalProfile(jsonfile);
+   }
+
    // process solution status
    switch( status )
    {
@@ -321,6 +891,7 @@ int GamsIpopt::callSolver()
       case Restoration_Failed:
       case Error_In_Step_Computation:
       case Feasible_Point_Found:
+         canwarmstart = true;
          break; // these should have been handled by FinalizeSolution already
 
       case Not_Enough_Degrees_Of_Freedom:
@@ -385,6 +956,8 @@ int GamsIpopt::callSolver()
 
 int GamsIpopt::modifyProblem()
 {
+   assert(gmo != NULL);
+   assert(gev != NULL);
    assert(IsValid(ipopt));
    assert(IsValid(nlp));
 
@@ -392,6 +965,10 @@ int GamsIpopt::modifyProblem()
    gmoObjReformSet(gmo, 1);
    gmoIndexBaseSet(gmo, 0);
 
+   // if there has not been a solve yet, then there is nothing to warmstart from
+   if( boundtype == NULL )
+      return 0;
+
    if( !warmstart )
    {
       ipopt->Options()->SetStringValue("warm_start_init_point", "yes");
@@ -407,7 +984,7 @@ int GamsIpopt::modifyProblem()
 
    // check whether structure of NLP did not change
    // we can assume that nonzero-structure and equation sense (=L=, ...) didn't change
-   // but for Ipopt it is a structural change if a variable bound appeared or disappeared
+   // but for Ipopt it is a structural change if a variable bound appeared or disappeared or a variable got fixed or unfixed
    bool structurechanged = false;
    for( int i = 0; i < gmoN(gmo); ++i )
    {
@@ -416,12 +993,19 @@ int GamsIpopt::modifyProblem()
          newboundtype |= 1u;
       if( gmoGetVarUpperOne(gmo, i) != gmoPinf(gmo) )
          newboundtype |= 2u;
+      if( gmoGetVarLowerOne(gmo, i) == gmoGetVarUpperOne(gmo, i) )
+         newboundtype |= 4u;
 
       if( boundtype[i] != newboundtype )
          structurechanged = true;
       boundtype[i] = newboundtype;
    }
-   ipopt->Options()->SetStringValue("warm_start_same_structure", structurechanged ? "no" : "yes");
+   if( structurechanged )
+      gevLog(gev, "Presence of variable bounds or fixings changed. Ipopt will rebuild its data structures.");
+
+   // with an unchanged structure, Ipopt reuses the Jacobian and Hessian structure and the linear solver setup of the previous solve
+   // with presolve, the structure of the NLP that Ipopt sees may change with the data
+   ipopt->Options()->SetStringValue("warm_start_same_structure", (structurechanged || nlp->presolve) ? "no" : "yes");
 
    return 0;
 }
@@ -495,7 +1079,9 @@ int ipoHaveModifyProblem(
    void* Cptr
 )
 {
-   return 0;
+   assert(Cptr != NULL);
+
+   return 1;
 }
 
 int ipoModifyProblem(
@@ -15,6 +15,7 @@ typedef struct gevRec* gevHandle_t;
 #include "GamsLinksConfig.h"
 #include "GamsNLP.hpp"
 
+#include <chrono>
 #include <cstdint>
 
 /** GAMS interface to Ipopt */
@@ -34,19 +35,49 @@ private:
 
    /// whether next solve should be a warmstart (use ReOptimizeTNLP)
    bool warmstart;
-   /// information which variable lower and upper bounds are present (bitflags)
+   /// whether the previous solve got far enough for Ipopt to allow a ReOptimizeTNLP
+   bool canwarmstart;
+   /// locally optimal solution of previous solve, if parametric mode is enabled
+   GamsNLPSolution lastsol;
+   /// information which variable lower and upper bounds are present and which variables are fixed (bitflags)
    uint8_t* boundtype;
+   /// start of current solve, to distribute the time limit onto probing, multistart, and final solve
+   std::chrono::steady_clock::time_point solvestart;
+   /// time limit for current solve, in seconds
+   double timelimit;
+
+   /// gives the time that is left for the current solve, in seconds
+   double remainingTime() const
+   {
+      return timelimit - std::chrono::duration<double>(std::chrono::steady_clock::now() - solvestart).count();
+   }
 
    /// sets up ipopt, allows for gev==NULL
    void setupIpopt();
 
+   /// creates an Ipopt instance that uses the options of the main instance, but prints nothing
+   ///
+   /// The wall-clock time limit is set to the time that is left for the current solve.
+   Ipopt::SmartPtr<Ipopt::IpoptApplication> createQuietIpopt();
+
+   /// runs a few iterations with each available linear solver and selects the one that spent least time
+   void probeLinearSolver();
+
+   /// runs Ipopt from several starting points in parallel and returns the best solution found, if any
+   bool multistart(
+      int                nstarts,            /**< number of starting points */
+      GamsNLPSolution&   best                /**< buffer to store best solution */
+   );
+
 public:
    GamsIpopt()
    : gmo(NULL),
      gev(NULL),
      ipoptlicensed(false),
      warmstart(false),
-     boundtype(NULL)
+     canwarmstart(false),
+     boundtype(NULL),
+     timelimit(0.0)
    { }
 
    ~GamsIpopt()
@@ -24,7 +24,6 @@
 
 #ifdef NOVSNPRINTF
 #define VSNPRINTF fakevsnprintf
-static char hugeBufVSN[10020];
 static int fakevsnprintf(
    char*                 str,
    size_t                size,
@@ -32,7 +31,8 @@ static int fakevsnprintf(
    va_list               ap
 )
 {
-   /* this better not overflow! */
+   /* buffer on stack, so that journals of Ipopt runs in several threads of a solve (multistart, racing) do not share it; this better not overflow! */
+   char hugeBufVSN[10020];
    int rc = vsprintf(hugeBufVSN, format, ap);
    assert(rc >= 0);
    assert(rc < sizeof(hugeBufVSN));
@@ -59,6 +59,10 @@ void GamsJournal::PrintImpl(
 {
    assert(gev != NULL);
 
+   std::unique_lock<std::mutex> lock;
+   if( mutex )
+      lock = std::unique_lock<std::mutex>(*mutex);
+
    if( level <= status_level )
       gevLogStatPChar(gev, str);
    else
@@ -7,6 +7,9 @@
 #ifndef GAMSJOURNAL_HPP_
 #define GAMSJOURNAL_HPP_
 
+#include <memory>
+#include <mutex>
+
 #include "IpJournalist.hpp"
 
 struct gevRec;
@@ -20,16 +23,21 @@ private:
    /** highest level for output to status file */
    Ipopt::EJournalLevel status_level;
 
+   /** mutex to sync gevLog calls, if output can come from several threads */
+   std::shared_ptr<std::mutex> mutex;
+
 public:
    GamsJournal(
       struct gevRec*       gev_,             /**< GAMS environment */
       const char*          name,             /**< journalist name */
       Ipopt::EJournalLevel default_level,    /**< default journal level */
-      Ipopt::EJournalLevel status_level_ = Ipopt::J_SUMMARY /**< journal level up to which print into status file */
+      Ipopt::EJournalLevel status_level_ = Ipopt::J_SUMMARY, /**< journal level up to which print into status file */
+      std::shared_ptr<std::mutex> mutex_ = std::shared_ptr<std::mutex>() /**< mutex to sync gevLog calls, or empty */
    )
    : Ipopt::Journal(name, default_level),
      gev(gev_),
-     status_level(status_level_)
+     status_level(status_level_),
+     mutex(mutex_)
    { }
 
 protected:
@@ -0,0 +1,129 @@
+// Copyright (C) GAMS Development and others
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// Author: Stefan Vigerske
+
+#ifndef GAMSLINEARSOLVER_HPP_
+#define GAMSLINEARSOLVER_HPP_
+
+#include "IpOptionsList.hpp"
+#include "IpRegOptions.hpp"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+
+/** gives the values of Ipopt option linear_solver that are available in this build of Ipopt */
+inline
+std::vector<std::string> GAMSavailableLinearSolvers(
+   Ipopt::RegisteredOptions& regoptions      /**< registered Ipopt options */
+)
+{
+   std::vector<std::string> solvers;
+
+   Ipopt::SmartPtr<const Ipopt::RegisteredOption> opt = regoptions.GetOption("linear_solver");
+   if( Ipopt::IsNull(opt) )
+      return solvers;
+
+   for( auto& e : opt->GetValidStrings() )
+      if( e.value_ != "custom" )
+         solvers.push_back(e.value_);
+
+   return solvers;
+}
+
+/** chooses a linear solver for Ipopt and its ordering from the size and structure of the KKT system and the number of threads
+ *
+ * Sets options linear_solver and, if applicable, the ordering option of the chosen solver.
+ * Returns a message that explains the choice.
+ */
+inline
+std::string GAMSselectLinearSolver(
+   Ipopt::OptionsList&        options,       /**< Ipopt options to modify */
+   Ipopt::RegisteredOptions&  regoptions,    /**< registered Ipopt options */
+   bool                       hsl,           /**< whether HSL solvers can be used */
+   int                        n,             /**< number of variables */
+   int                        m,             /**< number of constraints */
+   long long                  nnzjac,        /**< number of nonzeros in Jacobian */
+   long long                  nnzhess,       /**< number of nonzeros in lower-triangular Hessian */
+   int                        nthreads       /**< number of threads available */
+)
+{
+   std::vector<std::string> available = GAMSavailableLinearSolvers(regoptions);
+   auto isavailable = [&available](const char* solver)
+   {
+      return std::find(available.begin(), available.end(), solver) != available.end();
+   };
+
+   // lower triangle of KKT matrix: diagonal, Hessian, and Jacobian
+   long long dim = (long long)n + m;
+   long long nnzkkt = dim + nnzhess + nnzjac;
+   double density = dim > 0 ? (double)nnzkkt / dim : 0.0;
+
+   // small systems factorize fast anyway, so prefer solvers with least overhead
+   bool small = nnzkkt <= 100000;
+   // for very sparse rows, AMD is cheap and keeps fill-in low, otherwise nested dissection (METIS) pays off
+   bool useamd = density < 5.0;
+
+   char buffer[512];
+   std::string solver;
+   std::string why;
+   bool setorder = false;
+
+   if( hsl && small )
+   {
+      solver = "ma27";
+      why = "small KKT system";
+   }
+   else if( hsl && nthreads > 1 && isavailable("ma97") )
+   {
+      solver = "ma97";
+      why = "large KKT system and several threads";
+      options.SetStringValue("ma97_order", useamd ? "amd" : "metis");
+      setorder = true;
+   }
+   else if( hsl && isavailable("ma57") )
+   {
+      solver = "ma57";
+      why = "large KKT system and one thread";
+      options.SetIntegerValue("ma57_pivot_order", useamd ? 0 : 4);
+      setorder = true;
+   }
+   else if( hsl )
+   {
+      solver = "ma27";
+      why = "no other HSL solver available";
+   }
+   else if( !small && nthreads > 1 && isavailable("pardisomkl") )
+   {
+      solver = "pardisomkl";
+      why = "large KKT system and several threads";
+   }
+   else if( !small && nthreads > 1 && isavailable("spral") )
+   {
+      solver = "spral";
+      why = "large KKT system and several threads";
+   }
+   else
+   {
+      solver = "mumps";
+      why = small ? "small KKT system" : "large KKT system and no parallel solver available";
+      if( !small )
+      {
+         options.SetIntegerValue("mumps_pivot_order", useamd ? 0 : 5);
+         setorder = true;
+      }
+   }
+
+   options.SetStringValue("linear_solver", solver);
+
+   sprintf(buffer, "Linear solver %s selected: %s (dimension %lld, %lld nonzeros, %.1f nonzeros per row, %d threads)%s.",
+      solver.c_str(), why.c_str(), dim, nnzkkt, density, nthreads,
+      setorder ? (useamd ? ", AMD ordering" : ", METIS ordering") : "");
+
+   return buffer;
+}
+
+#endif
@@ -0,0 +1,862 @@
+// Copyright (C) GAMS Development and others
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// Author: Stefan Vigerske
+
+#include "GamsLinksConfig.h"
+#include "GamsNLEval.hpp"
+#include "GamsNLinstr.h"
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "gmomcc.h"
+
+/** minimal number of rows for which evaluation is distributed over threads */
+#define MINPARALLELROWS 64
+
+static
+int getMaxThreads()
+{
+#ifdef _OPENMP
+   return omp_get_max_threads();
+#else
+   return 1;
+#endif
+}
+
+static
+int getThreadNum()
+{
+#ifdef _OPENMP
+   return omp_get_thread_num();
+#else
+   return 0;
+#endif
+}
+
+/** whether a function code is a supported univariate function */
+static
+bool isSupportedFunc1(
+   int                func
+)
+{
+   switch( func )
+   {
+      case fnsqr:
+      case fnexp:
+      case fnlog:
+      case fnlog10:
+      case fnlog2:
+      case fnsqrt:
+      case fnabs:
+      case fncos:
+      case fnsin:
+      case fntan:
+      case fnarctan:
+      case fnsinh:
+      case fncosh:
+      case fntanh:
+         return true;
+      default:
+         return false;
+   }
+}
+
+GamsNLEvaluator::GamsNLEvaluator(
+   struct gmoRec*     gmo_
+)
+: gmo(gmo_),
+  maxnodes(0)
+{
+   assert(gmo != NULL);
+   n = gmoN(gmo);
+   rowpos.resize(gmoM(gmo), -1);
+
+   nodestart.push_back(0);
+   linstart.push_back(0);
+}
+
+bool GamsNLEvaluator::compileRow(
+   int                row,
+   int*               opcodes,
+   int*               fields,
+   const double*      constants
+)
+{
+   int codelen;
+   gmoDirtyGetRowFNLInstr(gmo, row, &codelen, opcodes, fields);
+
+   int first = (int)nodes.size();
+   std::vector<int> stack;
+   int nargs = -1;
+
+   // appends a node and returns its index relative to the first node of the row
+   auto addNode = [&](Op op, int func, int a, int b, double c)
+   {
+      Node node;
+      node.op = (unsigned char)op;
+      node.func = (unsigned char)func;
+      node.a = a;
+      node.b = b;
+      node.c = c;
+      nodes.push_back(node);
+      return (int)nodes.size() - 1 - first;
+   };
+   auto pop = [&stack]()
+   {
+      int top = stack.back();
+      stack.pop_back();
+      return top;
+   };
+   auto applyBinary = [&](Op op)
+   {
+      int b = pop();
+      int a = pop();
+      stack.push_back(addNode(op, 0, a, b, 0.0));
+   };
+
+   bool ok = true;
+   for( int i = 0; i < codelen && ok; ++i )
+   {
+      GamsOpCode opcode = (GamsOpCode)opcodes[i];
+      int address = fields[i]-1;
+
+      // check that stack has enough arguments for operations that take them from the stack
+      size_t needargs = 0;
+      switch( opcode )
+      {
+         case nlAdd:
+         case nlSub:
+         case nlMul:
+         case nlDiv:
+         case nlMulIAdd:
+            needargs = 2;
+            break;
+         case nlAddV:
+         case nlAddI:
+         case nlSubV:
+         case nlSubI:
+         case nlMulV:
+         case nlMulI:
+         case nlDivV:
+         case nlDivI:
+         case nlUMin:
+            needargs = 1;
+            break;
+         default:
+            break;
+      }
+      if( stack.size() < needargs )
+      {
+         ok = false;
+         break;
+      }
+
+      int var = -1;
+      if( opcode == nlPushV || opcode == nlAddV || opcode == nlSubV || opcode == nlMulV || opcode == nlDivV || opcode == nlUMinV )
+      {
+         var = gmoGetjSolver(gmo, address);
+         if( var < 0 || var >= n )
+         {
+            ok = false;
+            break;
+         }
+      }
+
+      switch( opcode )
+      {
+         case nlNoOp:
+         case nlStore:
+         case nlHeader:
+            break;
+
+         case nlEnd:
+            i = codelen;
+            break;
+
+         case nlPushV:
+            stack.push_back(addNode(OP_VAR, 0, var, -1, 0.0));
+            break;
+
+         case nlPushI:
+            stack.push_back(addNode(OP_CONST, 0, -1, -1, constants[address]));
+            break;
+
+         case nlPushZero:
+            stack.push_back(addNode(OP_CONST, 0, -1, -1, 0.0));
+            break;
+
+         case nlAdd:
+            applyBinary(OP_ADD);
+            break;
+
+         case nlAddV:
+            stack.push_back(addNode(OP_VAR, 0, var, -1, 0.0));
+            applyBinary(OP_ADD);
+            break;
+
+         case nlAddI:
+            stack.push_back(addNode(OP_CONST, 0, -1, -1, constants[address]));
+            applyBinary(OP_ADD);
+            break;
+
+         case nlSub:
+            applyBinary(OP_SUB);
+            break;
+
+         case nlSubV:
+            stack.push_back(addNode(OP_VAR, 0, var, -1, 0.0));
+            applyBinary(OP_SUB);
+            break;
+
+         case nlSubI:
+            stack.push_back(addNode(OP_CONST, 0, -1, -1, constants[address]));
+            applyBinary(OP_SUB);
+            break;
+
+         case nlMul:
+            applyBinary(OP_MUL);
+            break;
+
+         case nlMulV:
+            stack.push_back(addNode(OP_VAR, 0, var, -1, 0.0));
+            applyBinary(OP_MUL);
+            break;
+
+         case nlMulI:
+            stack.push_back(addNode(OP_CONST, 0, -1, -1, constants[address]));
+            applyBinary(OP_MUL);
+            break;
+
+         case nlMulIAdd:
+            // multiply top of stack by constant and add to element below
+            stack.push_back(addNode(OP_CONST, 0, -1, -1, constants[address]));
+            applyBinary(OP_MUL);
+            applyBinary(OP_ADD);
+            break;
+
+         case nlDiv:
+            applyBinary(OP_DIV);
+            break;
+
+         case nlDivV:
+            stack.push_back(addNode(OP_VAR, 0, var, -1, 0.0));
+            applyBinary(OP_DIV);
+            break;
+
+         case nlDivI:
+            stack.push_back(addNode(OP_CONST, 0, -1, -1, constants[address]));
+            applyBinary(OP_DIV);
+            break;
+
+         case nlUMin:
+            stack.push_back(addNode(OP_NEG, 0, pop(), -1, 0.0));
+            break;
+
+         case nlUMinV:
+            stack.push_back(addNode(OP_VAR, 0, var, -1, 0.0));
+            stack.push_back(addNode(OP_NEG, 0, pop(), -1, 0.0));
+            break;
+
+         case nlFuncArgN:
+            nargs = address + 1;  /* undo shift by 1 */
+            break;
+
+         case nlCallArg1:
+         case nlCallArg2:
+         case nlCallArgN:
+         {
+            int func = address + 1;  /* undo shift by 1 */
+            if( opcode == nlCallArg1 )
+               nargs = 1;
+            else if( opcode == nlCallArg2 )
+               nargs = 2;
+
+            if( nargs == 1 && isSupportedFunc1(func) && stack.size() >= 1 )
+            {
+               stack.push_back(addNode(OP_FUNC1, func, pop(), -1, 0.0));
+               break;
+            }
+
+            if( nargs == 2 && stack.size() >= 2 && (func == fnpower || func == fnrpower || func == fnvcpower || func == fncvpower) )
+            {
+               // second argument is on top of stack
+               const Node& base = nodes[first + stack[stack.size()-2]];
+               const Node& expo = nodes[first + stack[stack.size()-1]];
+
+               // power requires an integer exponent, vcpower a constant exponent, cvpower a constant base
+               if( func == fnpower && (expo.op != OP_CONST || expo.c != std::floor(expo.c)) )
+               {
+                  ok = false;
+                  break;
+               }
+               if( func == fnvcpower && expo.op != OP_CONST )
+               {
+                  ok = false;
+                  break;
+               }
+               if( func == fncvpower && base.op != OP_CONST )
+               {
+                  ok = false;
+                  break;
+               }
+
+               int b = pop();
+               int a = pop();
+               stack.push_back(addNode(OP_FUNC2, func, a, b, 0.0));
+               break;
+            }
+
+            ok = false;
+            break;
+         }
+
+         default:
+            // objective variable, invocations, checks, etc. are left to GMO
+            ok = false;
+            break;
+      }
+   }
+
+   // rows without instructions consist of their linear terms only
+   if( ok && stack.empty() && (int)nodes.size() == first )
+      stack.push_back(addNode(OP_CONST, 0, -1, -1, 0.0));
+
+   if( !ok || stack.size() != 1 || stack[0] != (int)nodes.size() - 1 - first )
+   {
+      nodes.resize(first);
+      return false;
+   }
+
+   // linear terms of row: variables with coefficients that are not marked as nonlinear
+   std::vector<int> colidx(n);
+   std::vector<double> colcoef(n);
+   std::vector<int> nlflag(n);
+   int nz, nlnz;
+   gmoGetRowSparse(gmo, row, colidx.data(), colcoef.data(), nlflag.data(), &nz, &nlnz);
+
+   // variables in instructions must be in the row, as evalGrad only collects the gradient entries of the row
+   std::vector<bool> inrow(n, false);
+   for( int k = 0; k < nz; ++k )
+      inrow[colidx[k]] = true;
+   for( size_t k = first; k < nodes.size(); ++k )
+      if( nodes[k].op == OP_VAR && !inrow[nodes[k].a] )
+      {
+         nodes.resize(first);
+         return false;
+      }
+
+   for( int k = 0; k < nz; ++k )
+      if( !nlflag[k] )
+      {
+         linidx.push_back(colidx[k]);
+         lincoef.push_back(colcoef[k]);
+      }
+
+   rowpos[row] = (int)rows.size();
+   rows.push_back(row);
+   nodestart.push_back((int)nodes.size());
+   linstart.push_back((int)linidx.size());
+   maxnodes = std::max(maxnodes, (int)nodes.size() - first);
+
+   return true;
+}
+
+int GamsNLEvaluator::compile(
+   int                nrows,
+   const int*         rowidx
+)
+{
+   int* opcodes = new int[gmoNLCodeSizeMaxRow(gmo)+1];
+   int* fields  = new int[gmoNLCodeSizeMaxRow(gmo)+1];
+   double* constants = (double*)gmoPPool(gmo);
+
+   int ncompiled = 0;
+   for( int r = 0; r < nrows; ++r )
+      if( compileRow(rowidx[r], opcodes, fields, constants) )
+         ++ncompiled;
+
+   delete[] opcodes;
+   delete[] fields;
+
+   return ncompiled;
+}
+
+void GamsNLEvaluator::prepareWorkspaces(
+   int                nthreads
+)
+{
+   if( (int)workspaces.size() < nthreads )
+      workspaces.resize(nthreads);
+
+   for( int t = 0; t < nthreads; ++t )
+      initWorkspace(workspaces[t]);
+}
+
+void GamsNLEvaluator::initWorkspace(
+   Workspace&         ws
+) const
+{
+   if( (int)ws.val.size() < maxnodes )
+   {
+      ws.val.resize(maxnodes);
+      ws.adj.resize(maxnodes);
+   }
+   if( (int)ws.dense.size() < n )
+      ws.dense.resize(n, 0.0);
+}
+
+int GamsNLEvaluator::forward(
+   int                k,
+   const double*      x,
+   double*            val
+) const
+{
+   const Node* node = &nodes[nodestart[k]];
+   int nnodes = nodestart[k+1] - nodestart[k];
+   int nerrors = 0;
+
+   for( int i = 0; i < nnodes; ++i, ++node )
+   {
+      double a = node->a >= 0 && node->op != OP_VAR ? val[node->a] : 0.0;
+      double b = node->b >= 0 ? val[node->b] : 0.0;
+      double& v = val[i];
+
+      switch( node->op )
+      {
+         case OP_VAR:
+            v = x[node->a];
+            break;
+         case OP_CONST:
+            v = node->c;
+            break;
+         case OP_ADD:
+            v = a + b;
+            break;
+         case OP_SUB:
+            v = a - b;
+            break;
+         case OP_MUL:
+            v = a * b;
+            break;
+         case OP_DIV:
+            if( b == 0.0 )
+               ++nerrors;
+            v = a / b;
+            break;
+         case OP_NEG:
+            v = -a;
+            break;
+         case OP_FUNC1:
+            switch( node->func )
+            {
+               case fnsqr:
+                  v = a * a;
+                  break;
+               case fnexp:
+                  v = exp(a);
+                  break;
+               case fnlog:
+                  if( a <= 0.0 )
+                     ++nerrors;
+                  v = log(a);
+                  break;
+               case fnlog10:
+                  if( a <= 0.0 )
+                     ++nerrors;
+                  v = log10(a);
+                  break;
+               case fnlog2:
+                  if( a <= 0.0 )
+                     ++nerrors;
+                  v = log2(a);
+                  break;
+               case fnsqrt:
+                  if( a < 0.0 )
+                     ++nerrors;
+                  v = sqrt(a);
+                  break;
+               case fnabs:
+                  v = fabs(a);
+                  break;
+               case fncos:
+                  v = cos(a);
+                  break;
+               case fnsin:
+                  v = sin(a);
+                  break;
+               case fntan:
+                  v = tan(a);
+                  break;
+               case fnarctan:
+                  v = atan(a);
+                  break;
+               case fnsinh:
+                  v = sinh(a);
+                  break;
+               case fncosh:
+                  v = cosh(a);
+                  break;
+               case fntanh:
+                  v = tanh(a);
+                  break;
+               default:
+                  assert(false);
+                  v = 0.0;
+                  break;
+            }
+            break;
+         case OP_FUNC2:
+            // real powers are only defined for a nonnegative base
+            if( node->func != fnpower && (a < 0.0 || (a == 0.0 && b <= 0.0)) )
+               ++nerrors;
+            else if( node->func == fnpower && a == 0.0 && b < 0.0 )
+               ++nerrors;
+            v = pow(a, b);
+            break;
+      }
+
+      if( !std::isfinite(v) )
+         ++nerrors;
+   }
+
+   return nerrors;
+}
+
+int GamsNLEvaluator::evalPos(
+   int                k,
+   const double*      x,
+   Workspace&         ws,
+   double&            value
+) const
+{
+   int nerrors = forward(k, x, ws.val.data());
+
+   value = ws.val[nodestart[k+1] - nodestart[k] - 1];
+   for( int p = linstart[k]; p < linstart[k+1]; ++p )
+      value += lincoef[p] * x[linidx[p]];
+
+   return nerrors;
+}
+
+int GamsNLEvaluator::evalPosGrad(
+   int                k,
+   const double*      x,
+   Workspace&         ws,
+   double&            value
+) const
+{
+   double* val = ws.val.data();
+   double* adj = ws.adj.data();
+   double* dense = ws.dense.data();
+
+   int nerrors = forward(k, x, val);
+
+   const Node* first = &nodes[nodestart[k]];
+   int nnodes = nodestart[k+1] - nodestart[k];
+
+   value = val[nnodes-1];
+   for( int p = linstart[k]; p < linstart[k+1]; ++p )
+      value += lincoef[p] * x[linidx[p]];
+
+   // reverse sweep: propagate adjoints from root to variables
+   for( int i = 0; i < nnodes-1; ++i )
+      adj[i] = 0.0;
+   adj[nnodes-1] = 1.0;
+
+   for( int i = nnodes-1; i >= 0; --i )
+   {
+      const Node& node = first[i];
+      double d = adj[i];
+      if( d == 0.0 && node.op != OP_VAR )
+         continue;
+
+      switch( node.op )
+      {
+         case OP_VAR:
+            // derivatives can be infinite where function values are finite, e.g., sqrt at 0
+            if( !std::isfinite(d) )
+               ++nerrors;
+            dense[node.a] += d;
+            break;
+         case OP_CONST:
+            break;
+         case OP_ADD:
+            adj[node.a] += d;
+            adj[node.b] += d;
+            break;
+         case OP_SUB:
+            adj[node.a] += d;
+            adj[node.b] -= d;
+            break;
+         case OP_MUL:
+            adj[node.a] += d * val[node.b];
+            adj[node.b] += d * val[node.a];
+            break;
+         case OP_DIV:
+            adj[node.a] += d / val[node.b];
+            adj[node.b] -= d * val[i] / val[node.b];
+            break;
+         case OP_NEG:
+            adj[node.a] -= d;
+            break;
+         case OP_FUNC1:
+         {
+            double a = val[node.a];
+            double deriv;
+            switch( node.func )
+            {
+               case fnsqr:
+                  deriv = 2.0 * a;
+                  break;
+               case fnexp:
+                  deriv = val[i];
+                  break;
+               case fnlog:
+                  deriv = 1.0 / a;
+                  break;
+               case fnlog10:
+                  deriv = 1.0 / (a * log(10.0));
+                  break;
+               case fnlog2:
+                  deriv = 1.0 / (a * log(2.0));
+                  break;
+               case fnsqrt:
+                  deriv = 0.5 / val[i];
+                  break;
+               case fnabs:
+                  deriv = a > 0.0 ? 1.0 : (a < 0.0 ? -1.0 : 0.0);
+                  break;
+               case fncos:
+                  deriv = -sin(a);
+                  break;
+               case fnsin:
+                  deriv = cos(a);
+                  break;
+               case fntan:
+                  deriv = 1.0 / (cos(a) * cos(a));
+                  break;
+               case fnarctan:
+                  deriv = 1.0 / (1.0 + a * a);
+                  break;
+               case fnsinh:
+                  deriv = cosh(a);
+                  break;
+               case fncosh:
+                  deriv = sinh(a);
+                  break;
+               case fntanh:
+                  deriv = 1.0 - val[i] * val[i];
+                  break;
+               default:
+                  assert(false);
+                  deriv = 0.0;
+                  break;
+            }
+            adj[node.a] += d * deriv;
+            break;
+         }
+         case OP_FUNC2:
+         {
+            double a = val[node.a];
+            double b = val[node.b];
+            if( b != 0.0 )
+               adj[node.a] += d * b * pow(a, b - 1.0);
+            if( first[node.b].op != OP_CONST && a > 0.0 )
+               adj[node.b] += d * val[i] * log(a);
+            break;
+         }
+      }
+   }
+
+   for( int p = linstart[k]; p < linstart[k+1]; ++p )
+      dense[linidx[p]] += lincoef[p];
+
+   return nerrors;
+}
+
+int GamsNLEvaluator::verify(
+   const double*      x,
+   const int*         iRowStart,
+   const int*         jCol
+)
+{
+   int nrows = (int)rows.size();
+   if( nrows == 0 )
+      return 0;
+
+   prepareWorkspaces(1);
+   Workspace& ws = workspaces[0];
+
+   std::vector<double> grad(n);
+   std::vector<bool> keep(nrows, true);
+   gmoEvalNewPoint(gmo, x);
+
+   int ndropped = 0;
+   for( int k = 0; k < nrows; ++k )
+   {
+      int row = rows[k];
+
+      double gmoval;
+      double gx;
+      int gmoerrors;
+      int rc = gmoEvalGrad(gmo, row, x, &gmoval, grad.data(), &gx, &gmoerrors);
+
+      double val;
+      int nerrors = evalPosGrad(k, x, ws, val);
+
+      bool match = rc == 0 && (gmoerrors > 0) == (nerrors > 0);
+      // if both report a domain error, then the values are not meaningful
+      if( match && nerrors == 0 )
+      {
+         match = val == gmoval;
+         for( int p = iRowStart[row]; p < iRowStart[row+1]; ++p )
+            if( ws.dense[jCol[p]] != grad[jCol[p]] )
+               match = false;
+      }
+
+      for( int p = iRowStart[row]; p < iRowStart[row+1]; ++p )
+         ws.dense[jCol[p]] = 0.0;
+
+      if( !match )
+      {
+         keep[k] = false;
+         ++ndropped;
+      }
+   }
+
+   if( ndropped > 0 )
+      removeRows(keep);
+
+   return ndropped;
+}
+
+void GamsNLEvaluator::removeRows(
+   const std::vector<bool>& keep
+)
+{
+   int nrows = (int)rows.size();
+   std::vector<int> newrows;
+   std::vector<int> newnodestart(1, 0);
+   std::vector<Node> newnodes;
+   std::vector<int> newlinstart(1, 0);
+   std::vector<int> newlinidx;
+   std::vector<double> newlincoef;
+   for( int k = 0; k < nrows; ++k )
+   {
+      if( !keep[k] )
+      {
+         rowpos[rows[k]] = -1;
+         continue;
+      }
+      rowpos[rows[k]] = (int)newrows.size();
+      newrows.push_back(rows[k]);
+      newnodes.insert(newnodes.end(), nodes.begin() + nodestart[k], nodes.begin() + nodestart[k+1]);
+      newnodestart.push_back((int)newnodes.size());
+      newlinidx.insert(newlinidx.end(), linidx.begin() + linstart[k], linidx.begin() + linstart[k+1]);
+      newlincoef.insert(newlincoef.end(), lincoef.begin() + linstart[k], lincoef.begin() + linstart[k+1]);
+      newlinstart.push_back((int)newlinidx.size());
+   }
+   rows.swap(newrows);
+   nodestart.swap(newnodestart);
+   nodes.swap(newnodes);
+   linstart.swap(newlinstart);
+   linidx.swap(newlinidx);
+   lincoef.swap(newlincoef);
+}
+
+int GamsNLEvaluator::evalRow(
+   int                row,
+   const double*      x,
+   Workspace&         ws,
+   double&            value
+) const
+{
+   assert(isCompiled(row));
+
+   return evalPos(rowpos[row], x, ws, value);
+}
+
+int GamsNLEvaluator::evalRowGrad(
+   int                row,
+   const double*      x,
+   Workspace&         ws,
+   double&            value,
+   int                nnz,
+   const int*         cols,
+   double*            grad
+) const
+{
+   assert(isCompiled(row));
+
+   int nerrors = evalPosGrad(rowpos[row], x, ws, value);
+
+   // collect gradient entries of row and reset dense gradient for next row
+   for( int p = 0; p < nnz; ++p )
+   {
+      grad[p] = ws.dense[cols[p]];
+      ws.dense[cols[p]] = 0.0;
+   }
+
+   return nerrors;
+}
+
+int GamsNLEvaluator::evalFunc(
+   const double*      x,
+   double*            g
+)
+{
+   int nrows = (int)rows.size();
+   int nerrors = 0;
+
+   prepareWorkspaces(getMaxThreads());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) reduction(+:nerrors) if(nrows >= MINPARALLELROWS)
+#endif
+   for( int k = 0; k < nrows; ++k )
+      nerrors += evalPos(k, x, workspaces[getThreadNum()], g[rows[k]]);
+
+   return nerrors;
+}
+
+int GamsNLEvaluator::evalGrad(
+   const double*      x,
+   double*            g,
+   const int*         iRowStart,
+   const int*         jCol,
+   double*            jacval
+)
+{
+   int nrows = (int)rows.size();
+   int nerrors = 0;
+
+   prepareWorkspaces(getMaxThreads());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) reduction(+:nerrors) if(nrows >= MINPARALLELROWS)
+#endif
+   for( int k = 0; k < nrows; ++k )
+   {
+      Workspace& ws = workspaces[getThreadNum()];
+      int row = rows[k];
+
+      nerrors += evalPosGrad(k, x, ws, g[row]);
+
+      // collect gradient entries of row and reset dense gradient for next row
+      for( int p = iRowStart[row]; p < iRowStart[row+1]; ++p )
+      {
+         jacval[p] = ws.dense[jCol[p]];
+         ws.dense[jCol[p]] = 0.0;
+      }
+   }
+
+   return nerrors;
+}
@@ -0,0 +1,227 @@
+// Copyright (C) GAMS Development and others
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// Author: Stefan Vigerske
+
+#ifndef GAMSNLEVAL_HPP_
+#define GAMSNLEVAL_HPP_
+
+#include <vector>
+
+struct gmoRec;
+
+/** evaluates nonlinear rows of a GMO and their gradients from a compiled copy of the GAMS instructions
+ *
+ * Unlike GMO, the evaluator can be used from several threads at the same time.
+ * evalFunc and evalGrad evaluate all rows in parallel by OpenMP, if available, using as many threads as omp_get_max_threads() gives.
+ * evalRow and evalRowGrad evaluate a single row with working memory that is owned by the caller,
+ * so they can be called concurrently from threads that are not managed by OpenMP.
+ * Rows with instructions that the evaluator does not support are not compiled and need to be evaluated by GMO.
+ */
+class GamsNLEvaluator
+{
+public:
+   /** working memory of one thread */
+   struct Workspace
+   {
+      std::vector<double> val;               /**< value of each node */
+      std::vector<double> adj;               /**< adjoint of each node */
+      std::vector<double> dense;             /**< dense gradient, zero outside of a row evaluation */
+   };
+
+private:
+   /** operations of compiled instructions */
+   enum Op
+   {
+      OP_VAR,                                /**< variable */
+      OP_CONST,                              /**< constant */
+      OP_ADD,                                /**< a + b */
+      OP_SUB,                                /**< a - b */
+      OP_MUL,                                /**< a * b */
+      OP_DIV,                                /**< a / b */
+      OP_NEG,                                /**< -a */
+      OP_FUNC1,                              /**< univariate function of a */
+      OP_FUNC2                               /**< bivariate function of a and b */
+   };
+
+   /** a compiled instruction, arguments refer to earlier instructions of the same row */
+   struct Node
+   {
+      unsigned char      op;                 /**< operation */
+      unsigned char      func;               /**< GAMS function code, if op is OP_FUNC1 or OP_FUNC2 */
+      int                a;                  /**< first argument, or variable index if op is OP_VAR */
+      int                b;                  /**< second argument */
+      double             c;                  /**< value if op is OP_CONST */
+   };
+
+   struct gmoRec*        gmo;                /**< GAMS modeling object */
+   int                   n;                  /**< number of variables */
+
+   std::vector<int>      rows;               /**< compiled rows */
+   std::vector<int>      rowpos;             /**< position of each row in rows, or -1 if not compiled */
+   std::vector<int>      nodestart;          /**< start of instructions of each compiled row in nodes */
+   std::vector<Node>     nodes;              /**< compiled instructions of all compiled rows */
+   std::vector<int>      linstart;           /**< start of linear terms of each compiled row in linidx and lincoef */
+   std::vector<int>      linidx;             /**< variable indices of linear terms */
+   std::vector<double>   lincoef;            /**< coefficients of linear terms */
+   int                   maxnodes;           /**< maximal number of instructions of a compiled row */
+
+   std::vector<Workspace> workspaces;        /**< working memory for each thread */
+
+   /** translates the GAMS instructions of a row into nodes
+    *
+    * Returns false if the instructions contain an unsupported operation.
+    */
+   bool compileRow(
+      int                row,                /**< row index */
+      int*               opcodes,            /**< buffer for instruction opcodes */
+      int*               fields,             /**< buffer for instruction fields */
+      const double*      constants           /**< GAMS constants pool */
+   );
+
+   /** makes sure there is working memory for the given number of threads */
+   void prepareWorkspaces(
+      int                nthreads            /**< number of threads */
+   );
+
+   /** removes rows from the compiled instructions */
+   void removeRows(
+      const std::vector<bool>& keep          /**< whether to keep the row at each position in rows */
+   );
+
+   /** evaluates instructions of a compiled row, storing the value of each node in val
+    *
+    * Returns the number of domain errors.
+    */
+   int forward(
+      int                k,                  /**< position of row in rows */
+      const double*      x,                  /**< point */
+      double*            val                 /**< buffer for node values */
+   ) const;
+
+   /** evaluates a compiled row at a point, including its linear terms
+    *
+    * Returns the number of domain errors.
+    */
+   int evalPos(
+      int                k,                  /**< position of row in rows */
+      const double*      x,                  /**< point */
+      Workspace&         ws,                 /**< working memory */
+      double&            value               /**< buffer for row value */
+   ) const;
+
+   /** evaluates a compiled row and its gradient at a point, including its linear terms
+    *
+    * The gradient is stored in the dense array of the workspace.
+    * Returns the number of domain errors.
+    */
+   int evalPosGrad(
+      int                k,                  /**< position of row in rows */
+      const double*      x,                  /**< point */
+      Workspace&         ws,                 /**< working memory */
+      double&            value               /**< buffer for row value */
+   ) const;
+
+public:
+   GamsNLEvaluator(
+      struct gmoRec*     gmo_                /**< GAMS modeling object */
+   );
+
+   /** compiles the instructions of the given rows, skipping rows with unsupported instructions
+    *
+    * Returns the number of rows that have been compiled.
+    */
+   int compile(
+      int                nrows,              /**< number of rows */
+      const int*         rowidx              /**< indices of rows to compile */
+   );
+
+   /** compares values and gradients of compiled rows with those from GMO at a point and forgets rows where they differ
+    *
+    * Values and gradients need to match exactly, and a domain error in GMO needs to be a domain error of the evaluator.
+    * This only checks the given point: elsewhere, results of kept rows can still differ from GMO by rounding,
+    * since the order of floating-point operations in GMO is not known.
+    * Returns the number of rows that have been forgotten.
+    */
+   int verify(
+      const double*      x,                  /**< point */
+      const int*         iRowStart,          /**< row starts in Jacobian */
+      const int*         jCol                /**< column indices in Jacobian */
+   );
+
+   /** number of compiled rows */
+   int getNRows() const
+   {
+      return (int)rows.size();
+   }
+
+   /** indices of compiled rows */
+   const std::vector<int>& getRows() const
+   {
+      return rows;
+   }
+
+   /** whether a row has been compiled */
+   bool isCompiled(
+      int                row                 /**< row index */
+   ) const
+   {
+      return rowpos[row] >= 0;
+   }
+
+   /** makes sure that working memory is large enough for evalRow and evalRowGrad */
+   void initWorkspace(
+      Workspace&         ws                  /**< working memory */
+   ) const;
+
+   /** evaluates a compiled row at a point
+    *
+    * Returns the number of domain errors.
+    */
+   int evalRow(
+      int                row,                /**< row index */
+      const double*      x,                  /**< point */
+      Workspace&         ws,                 /**< working memory, initialized by initWorkspace */
+      double&            value               /**< buffer for row value */
+   ) const;
+
+   /** evaluates a compiled row and its gradient at a point
+    *
+    * Returns the number of domain errors.
+    */
+   int evalRowGrad(
+      int                row,                /**< row index */
+      const double*      x,                  /**< point */
+      Workspace&         ws,                 /**< working memory, initialized by initWorkspace */
+      double&            value,              /**< buffer for row value */
+      int                nnz,                /**< number of variables in row */
+      const int*         cols,               /**< indices of variables in row */
+      double*            grad                /**< buffer for gradient entries of variables in row */
+   ) const;
+
+   /** evaluates all compiled rows at a point
+    *
+    * Stores the value of row i in g[i].
+    * Returns the number of domain errors.
+    */
+   int evalFunc(
+      const double*      x,                  /**< point */
+      double*            g                   /**< buffer for row values */
+   );
+
+   /** evaluates all compiled rows and their gradients at a point
+    *
+    * Stores the value of row i in g[i] and its gradient in the Jacobian values of row i.
+    * Returns the number of domain errors.
+    */
+   int evalGrad(
+      const double*      x,                  /**< point */
+      double*            g,                  /**< buffer for row values */
+      const int*         iRowStart,          /**< row starts in Jacobian */
+      const int*         jCol,               /**< column indices in Jacobian */
+      double*            jacval              /**< buffer for Jacobian values */
+   );
+};
+
+#endif /* GAMSNLEVAL_HPP_ */
@@ -9,23 +9,116 @@
 
 #include "IpIpoptCalculatedQuantities.hpp"
 #include "IpIpoptData.hpp"
+#include "IpTimingStatistics.hpp"
+#include "IpUtils.hpp"
 
 #include <cstring> // for memset
+#include <cmath>
 #include <cstdio>  // for sprintf
 #include <cassert>
+#include <algorithm>
+#include <unordered_map>
 
 #include "gmomcc.h"
 #include "gevmcc.h"
 
 using namespace Ipopt;
 
+void GamsNLPEvalTiming::reset()
+{
+   ncalls = 0;
+   walltime = 0.0;
+   cputime = 0.0;
+   maxwalltime = 0.0;
+   for( int i = 0; i < nbuckets; ++i )
+      histogram[i] = 0;
+}
+
+void GamsNLPEvalTiming::add(
+   double             wall,
+   double             cpu
+)
+{
+   ++ncalls;
+   walltime += wall;
+   cputime += cpu;
+   if( wall > maxwalltime )
+      maxwalltime = wall;
+
+   int bucket = 0;
+   for( double limit = 1e-6; bucket < nbuckets-1 && wall >= limit; limit *= 10.0 )
+      ++bucket;
+   ++histogram[bucket];
+}
+
+/** measures wall-clock and CPU time of an evaluation callback from construction to destruction */
+class GamsNLPEvalTimer
+{
+private:
+   GamsNLPEvalTiming*    timing;             /**< where to add time to, or NULL if not profiling */
+   double                wallstart;          /**< wall-clock time at start */
+   double                cpustart;           /**< CPU time at start */
+
+public:
+   GamsNLPEvalTimer(
+      GamsNLPEvalTiming* timing_             /**< where to add time to, or NULL if not profiling */
+   )
+   : timing(timing_)
+   {
+      if( timing != NULL )
+      {
+         wallstart = WallclockTime();
+         cpustart = CpuTime();
+      }
+   }
+
+   ~GamsNLPEvalTimer()
+   {
+      if( timing != NULL )
+         timing->add(WallclockTime() - wallstart, CpuTime() - cpustart);
+   }
+};
+
 GamsNLP::GamsNLP(
    struct gmoRec*     gmo_                /**< GAMS modeling object */
 )
 : domviolations(0),
   iRowStart(NULL),
   jCol(NULL),
+  jacval(NULL),
+  linrows(NULL),
+  nlinrows(0),
+  nlrows(NULL),
+  nnlrows(0),
   grad(NULL),
+  nleval(NULL),
+  newpoint(true),
+  quadhess(false),
+  quadhessstale(false),
+  objqnz(0),
+  objqhesspos(NULL),
+  objqcoef(NULL),
+  rowqstart(NULL),
+  rowqhesspos(NULL),
+  rowqcoef(NULL),
+  gcache(NULL),
+  jaccache(NULL),
+  gcachevalid(false),
+  fcache(0.0),
+  gradfcache(NULL),
+  fcachevalid(false),
+  nevalf(0),
+  nevalfcached(0),
+  nevalg(0),
+  nevalgcached(0),
+  nevalgradf(0),
+  nevalgradfcached(0),
+  nevaljacg(0),
+  nevaljacgcached(0),
+  ipopttotalwall(0.0),
+  ipopttotalcpu(0.0),
+  ipoptlinsolwall(0.0),
+  ipoptlinsolcpu(0.0),
   mininfeasiter(-1),
   mininfeasconviol(1E+20),
   mininfeasprimals(NULL),
@@ -37,10 +130,23 @@ GamsNLP::GamsNLP(
   mininfeascomplxlb(NULL),
   mininfeascomplxub(NULL),
   mininfeascomplg(NULL),
+  presolved(false),
+  pn(0),
+  pm(0),
   div_iter_tol(1E+20),
   conviol_tol(1E-6),
   compl_tol(1E-4),
-  reportmininfeas(false)
+  reportmininfeas(false),
+  profile(false),
+  sharedgmo(NULL),
+  initx(NULL),
+  initzl(NULL),
+  initzu(NULL),
+  initlambda(NULL),
+  storesol(NULL),
+  keepsol(NULL),
+  presolve(false),
+  paralleleval(false)
 {
    gmo = gmo_;
    assert(gmo != NULL);
@@ -49,6 +155,15 @@ GamsNLP::GamsNLP(
 
    domviollimit = gevGetIntOpt(gev, gevDomLim);
 
+   // in Q mode, GMO counts quadratic terms separately from nonlinear ones
+   linear = gmoNLNZ(gmo) == 0 && gmoObjNLNZ(gmo) == 0;
+   if( linear && gmoUseQ(gmo) )
+   {
+      linear = gmoGetObjOrder(gmo) <= gmoorder_L;
+      for( int i = 0; i < gmoM(gmo) && linear; ++i )
+         linear = gmoGetEquOrderOne(gmo, i) <= gmoorder_L;
+   }
+
    /* stop fast in case of eval errors, since we do not look into values anyway */
    gmoEvalErrorMethodSet(gmo, gmoEVALERRORMETHOD_FASTSTOP);
 }
@@ -57,7 +172,20 @@ GamsNLP::~GamsNLP()
 {
    delete[] iRowStart;
    delete[] jCol;
+   delete[] jacval;
+   delete[] linrows;
+   delete[] nlrows;
    delete[] grad;
+   if( sharedgmo == NULL )
+      delete nleval;
+   delete[] objqhesspos;
+   delete[] objqcoef;
+   delete[] rowqstart;
+   delete[] rowqhesspos;
+   delete[] rowqcoef;
+   delete[] gcache;
+   delete[] jaccache;
+   delete[] gradfcache;
    delete[] mininfeasprimals;
    delete[] mininfeasviol;
    delete[] mininfeasactivity;
@@ -69,6 +197,1011 @@ GamsNLP::~GamsNLP()
    delete[] mininfeascomplg;
 }
 
+void GamsNLP::printEvalStatistics(
+   bool               print
+)
+{
+   char buffer[255];
+
+   if( print && (nevalf > 0 || nevalg > 0) )
+   {
+      sprintf(buffer, "Objective evaluations: %ld function (%ld reused), %ld gradient (%ld reused)\n",
+         nevalf, nevalfcached, nevalgradf, nevalgradfcached);
+      gevLogPChar(gev, buffer);
+      sprintf(buffer, "Constraint evaluations: %ld function (%ld reused), %ld Jacobian (%ld reused)\n",
+         nevalg, nevalgcached, nevaljacg, nevaljacgcached);
+      gevLogPChar(gev, buffer);
+   }
+
+   nevalf = 0;
+   nevalfcached = 0;
+   nevalg = 0;
+   nevalgcached = 0;
+   nevalgradf = 0;
+   nevalgradfcached = 0;
+   nevaljacg = 0;
+   nevaljacgcached = 0;
+}
+
+void GamsNLP::printEvalProfile(
+   const std::string& jsonfile
+)
+{
+   static const char* kindnames[EVAL_NKINDS] = { "eval_f", "eval_grad_f", "eval_g", "eval_jac_g", "eval_h" };
+   char buffer[512];
+
+   double evalwall = 0.0;
+   double evalcpu = 0.0;
+   for( int k = 0; k < EVAL_NKINDS; ++k )
+   {
+      evalwall += evaltiming[k].walltime;
+      evalcpu += evaltiming[k].cputime;
+   }
+
+   gevLog(gev, "");
+   gevLog(gev, "Evaluation profile:");
+   gevLog(gev, "Callback       Calls   Wall(s)    CPU(s)  Avg(ms)  Max(ms) |  <1us <10us <.1ms  <1ms <10ms <.1s    <1s  >=1s");
+   for( int k = 0; k < EVAL_NKINDS; ++k )
+   {
+      const GamsNLPEvalTiming& t = evaltiming[k];
+      int len = sprintf(buffer, "%-11s %8ld %9.3f %9.3f %8.3f %8.3f |", kindnames[k], t.ncalls, t.walltime, t.cputime,
+         t.ncalls > 0 ? 1000.0 * t.walltime / t.ncalls : 0.0, 1000.0 * t.maxwalltime);
+      for( int b = 0; b < GamsNLPEvalTiming::nbuckets; ++b )
+         len += sprintf(buffer + len, " %5ld", t.histogram[b]);
+      gevLog(gev, buffer);
+   }
+   sprintf(buffer, "%-20s %9.3f %9.3f", "Total evaluations", evalwall, evalcpu);
+   gevLog(gev, buffer);
+   if( ipopttotalwall > 0.0 )
+   {
+      sprintf(buffer, "%-20s %9.3f %9.3f", "Linear solver", ipoptlinsolwall, ipoptlinsolcpu);
+      gevLog(gev, buffer);
+      sprintf(buffer, "%-20s %9.3f %9.3f", "Other Ipopt", ipopttotalwall - evalwall - ipoptlinsolwall, ipopttotalcpu - evalcpu - ipoptlinsolcpu);
+      gevLog(gev, buffer);
+      sprintf(buffer, "%-20s %9.3f %9.3f", "Total Ipopt", ipopttotalwall, ipopttotalcpu);
+      gevLog(gev, buffer);
+   }
+
+   if( !jsonfile.empty() )
+   {
+      FILE* f = fopen(jsonfile.c_str(), "w");
+      if( f == NULL )
+      {
+         sprintf(buffer, "Could not open file %.400s for writing evaluation profile.", jsonfile.c_str());
+         gevLogStat(gev, buffer);
+      }
+      else
+      {
+         fprintf(f, "{\n  \"callbacks\": {\n");
+         for( int k = 0; k < EVAL_NKINDS; ++k )
+         {
+            const GamsNLPEvalTiming& t = evaltiming[k];
+            fprintf(f, "    \"%s\": { \"calls\": %ld, \"wall\": %.9g, \"cpu\": %.9g, \"maxwall\": %.9g, \"histogram\": [",
+               kindnames[k], t.ncalls, t.walltime, t.cputime, t.maxwalltime);
+            for( int b = 0; b < GamsNLPEvalTiming::nbuckets; ++b )
+               fprintf(f, "%s%ld", b > 0 ? ", " : "", t.histogram[b]);
+            fprintf(f, "] }%s\n", k < EVAL_NKINDS-1 ? "," : "");
+         }
+         fprintf(f, "  },\n");
+         fprintf(f, "  \"histogram_bounds\": [1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1],\n");
+         fprintf(f, "  \"evaluation\": { \"wall\": %.9g, \"cpu\": %.9g },\n", evalwall, evalcpu);
+         fprintf(f, "  \"linear_solver\": { \"wall\": %.9g, \"cpu\": %.9g },\n", ipoptlinsolwall, ipoptlinsolcpu);
+         fprintf(f, "  \"ipopt_total\": { \"wall\": %.9g, \"cpu\": %.9g }\n", ipopttotalwall, ipopttotalcpu);
+         fprintf(f, "}\n");
+         fclose(f);
+      }
+   }
+
+   for( int k = 0; k < EVAL_NKINDS; ++k )
+      evaltiming[k].reset();
+   ipopttotalwall = 0.0;
+   ipopttotalcpu = 0.0;
+   ipoptlinsolwall = 0.0;
+   ipoptlinsolcpu = 0.0;
+}
+
+int GamsNLP::checkKKTPoint(
+   const GamsNLPSolution& sol,
+   double             tol,
+   std::vector<double>& activity
+)
+{
+   int n = gmoN(gmo);
+   int m = gmoM(gmo);
+
+   if( !sol.valid || (int)sol.x.size() != n || (int)sol.lambda.size() != m || iRowStart == NULL )
+      return -1;
+
+   std::vector<double> xl(n), xu(n), gl(m), gu(m);
+   if( !getBounds(xl.data(), xu.data(), gl.data(), gu.data()) )
+      return -1;
+
+   // coefficients of linear rows may have changed since the solve
+   gmoGetMatrixRow(gmo, iRowStart, jCol, jacval, NULL);
+
+   const double* x = sol.x.data();
+   double objval;
+   std::vector<double> gradf(n);
+   std::vector<double> jac(iRowStart[m]);
+   activity.resize(m);
+   if( !evalF(x, true, objval) ||
+       !evalGradF(x, false, gradf.data()) ||
+       !evalG(x, false, activity.data()) ||
+       !evalJacG(x, false, jac.data()) )
+      return -1;
+
+   // a bound or constraint counts as active if its multiplier is nonzero
+   // if the point violates an inactive one, then the active set changes
+   // if it violates an active one or an active one moved away from the point, then the active set may stay, but the point is not a KKT point anymore
+   const double activetol = 1e-6;
+   int result = 1;
+   for( int j = 0; j < n; ++j )
+   {
+      bool lbactive = xl[j] > gmoMinf(gmo) && sol.zl[j] > activetol;
+      bool ubactive = xu[j] < gmoPinf(gmo) && sol.zu[j] > activetol;
+      if( x[j] < xl[j] - conviol_tol || x[j] > xu[j] + conviol_tol )
+      {
+         if( !lbactive && !ubactive )
+            return -1;
+         result = 0;
+      }
+      else if( (lbactive && x[j] > xl[j] + conviol_tol) || (ubactive && x[j] < xu[j] - conviol_tol) )
+         result = 0;
+   }
+   for( int i = 0; i < m; ++i )
+   {
+      bool lhsactive = gl[i] > gmoMinf(gmo) && sol.lambda[i] < -activetol;
+      bool rhsactive = gu[i] < gmoPinf(gmo) && sol.lambda[i] > activetol;
+      if( activity[i] < gl[i] - conviol_tol || activity[i] > gu[i] + conviol_tol )
+      {
+         if( !lhsactive && !rhsactive )
+            return -1;
+         result = 0;
+      }
+      else if( (lhsactive && activity[i] > gl[i] + conviol_tol) || (rhsactive && activity[i] < gu[i] - conviol_tol) )
+         result = 0;
+   }
+   if( result == 0 )
+      return 0;
+
+   // stationarity: gradient of Lagrangian needs to vanish, scaled as in Ipopts convergence check
+   std::vector<double> gradlag(gradf);
+   double multnorm = 0.0;
+   for( int j = 0; j < n; ++j )
+   {
+      if( xl[j] > gmoMinf(gmo) )
+      {
+         gradlag[j] -= sol.zl[j];
+         multnorm += std::abs(sol.zl[j]);
+      }
+      if( xu[j] < gmoPinf(gmo) )
+      {
+         gradlag[j] += sol.zu[j];
+         multnorm += std::abs(sol.zu[j]);
+      }
+   }
+   for( int i = 0; i < m; ++i )
+   {
+      for( int k = iRowStart[i]; k < iRowStart[i+1]; ++k )
+         gradlag[jCol[k]] += sol.lambda[i] * jac[k];
+      multnorm += std::abs(sol.lambda[i]);
+   }
+
+   double dualinf = 0.0;
+   for( int j = 0; j < n; ++j )
+      dualinf = std::max(dualinf, std::abs(gradlag[j]));
+
+   double scale = std::max(1.0, multnorm / std::max(n + m, 1) / 100.0);
+   if( dualinf > tol * scale )
+      return 0;
+
+   return 1;
+}
+
+void GamsNLP::reportKKTPoint(
+   const GamsNLPSolution& sol,
+   const std::vector<double>& activity
+)
+{
+   int n = gmoN(gmo);
+   int m = gmoM(gmo);
+
+   assert((int)sol.x.size() == n);
+   assert((int)activity.size() == m);
+
+   int*    colBasStat = new int[n];
+   int*    colIndic   = new int[n];
+   double* colMarg    = new double[n];
+   for( int j = 0; j < n; ++j )
+   {
+      colBasStat[j] = gmoBstat_Super;
+      colIndic[j] = gmoCstat_OK;
+      colMarg[j] = sol.zl[j] - sol.zu[j];
+   }
+
+   int*    rowBasStat = new int[m];
+   int*    rowIndic   = new int[m];
+   double* negLambda  = new double[m];
+   for( int i = 0; i < m; ++i )
+   {
+      rowBasStat[i] = gmoBstat_Super;
+      rowIndic[i] = gmoCstat_OK;
+      negLambda[i] = -sol.lambda[i];
+   }
+
+   gmoModelStatSet(gmo, !linear ? gmoModelStat_OptimalLocal : gmoModelStat_OptimalGlobal);
+   gmoSolveStatSet(gmo, gmoSolveStat_Normal);
+
+   /* this also sets the gmoHobjval attribute to the level value of GAMS' objective variable */
+   gmoSetSolution8(gmo, sol.x.data(), colMarg, negLambda, activity.data(), colBasStat, colIndic, rowBasStat, rowIndic);
+
+   gmoSetHeadnTail(gmo, gmoTninf, 0.0);
+   gmoSetHeadnTail(gmo, gmoTnopt, 0.0);
+
+   delete[] colBasStat;
+   delete[] colIndic;
+   delete[] colMarg;
+   delete[] rowBasStat;
+   delete[] rowIndic;
+   delete[] negLambda;
+}
+
+void GamsNLP::setupQuadHessian(
+   int                nele_hess
+)
+{
+   int n = gmoN(gmo);
+   int m = gmoM(gmo);
+
+   delete[] objqhesspos;
+   delete[] objqcoef;
+   delete[] rowqstart;
+   delete[] rowqhesspos;
+   delete[] rowqcoef;
+   objqhesspos = NULL;
+   objqcoef = NULL;
+   rowqstart = NULL;
+   rowqhesspos = NULL;
+   rowqcoef = NULL;
+   objqnz = 0;
+   quadhess = false;
+   quadhessstale = false;
+
+   // the quadratic coefficients are only available in Q mode, which the caller sets up once for quadratic models, as switching it is expensive
+   if( linear || !gmoUseQ(gmo) )
+      return;
+
+   // check whether objective and all constraints are at most quadratic
+   bool isquad = gmoGetObjOrder(gmo) <= gmoorder_Q;
+   for( int i = 0; i < m && isquad; ++i )
+      if( gmoGetEquOrderOne(gmo, i) > gmoorder_Q )
+         isquad = false;
+
+   if( isquad )
+   {
+      // position of each entry of the lower-triangular Hessian
+      int* hessrow = new int[nele_hess];
+      int* hesscol = new int[nele_hess];
+      gmoHessLagStruct(gmo, hessrow, hesscol);
+      std::unordered_map<long long, int> hesspos;
+      hesspos.reserve(nele_hess);
+      for( int k = 0; k < nele_hess; ++k )
+         hesspos[(long long)std::max(hessrow[k], hesscol[k]) * n + std::min(hessrow[k], hesscol[k])] = k;
+      delete[] hessrow;
+      delete[] hesscol;
+
+      if( gmoGetObjOrder(gmo) == gmoorder_Q )
+         objqnz = gmoObjQNZ(gmo);
+      int maxqnz = std::max(gmoMaxQNZ(gmo), objqnz);
+      int* qcol = new int[maxqnz];
+      int* qrow = new int[maxqnz];
+
+      // GMO gives each coefficient of x_i*x_j once and twice the coefficient of x_i^2, so these are the entries of the lower-triangular Hessian
+      quadhess = true;
+      objqhesspos = new int[objqnz];
+      objqcoef = new double[objqnz];
+      if( objqnz > 0 )
+      {
+         gmoGetObjQ(gmo, qcol, qrow, objqcoef);
+         for( int k = 0; k < objqnz && quadhess; ++k )
+         {
+            std::unordered_map<long long, int>::const_iterator it = hesspos.find((long long)std::max(qrow[k], qcol[k]) * n + std::min(qrow[k], qcol[k]));
+            if( it == hesspos.end() )
+               quadhess = false;
+            else
+               objqhesspos[k] = it->second;
+         }
+      }
+
+      int rowqnz = 0;
+      rowqstart = new int[m+1];
+      for( int i = 0; i < m; ++i )
+      {
+         rowqstart[i] = rowqnz;
+         if( gmoGetEquOrderOne(gmo, i) == gmoorder_Q )
+            rowqnz += gmoGetRowQNZOne(gmo, i);
+      }
+      rowqstart[m] = rowqnz;
+
+      rowqhesspos = new int[rowqnz];
+      rowqcoef = new double[rowqnz];
+      for( int i = 0; i < m && quadhess; ++i )
+      {
+         if( rowqstart[i] == rowqstart[i+1] )
+            continue;
+         gmoGetRowQ(gmo, i, qcol, qrow, &rowqcoef[rowqstart[i]]);
+         for( int k = 0; k < rowqstart[i+1] - rowqstart[i] && quadhess; ++k )
+         {
+            std::unordered_map<long long, int>::const_iterator it = hesspos.find((long long)std::max(qrow[k], qcol[k]) * n + std::min(qrow[k], qcol[k]));
+            if( it == hesspos.end() )
+               quadhess = false;
+            else
+               rowqhesspos[rowqstart[i] + k] = it->second;
+         }
+      }
+
+      delete[] qcol;
+      delete[] qrow;
+   }
+}
+
+void GamsNLP::setupJacobian()
+{
+   int n = gmoN(gmo);
+   int m = gmoM(gmo);
+   int nele_jac = gmoNZ(gmo);
+
+   if( iRowStart != NULL )
+   {
+      // coefficients of linear rows may have changed since a previous solve (e.g., GUSS), so refresh them
+      gmoGetMatrixRow(gmo, iRowStart, jCol, jacval, NULL);
+      gcachevalid = false;
+      fcachevalid = false;
+
+      // compiling and verifying the evaluator is expensive, so redo this only if constants have changed
+      // a shared evaluator belongs to a single solve, so is kept
+      if( sharedgmo == NULL && nleval != NULL &&
+         (gmoNLConst(gmo) != (int)nlevalconstants.size() || memcmp((double*)gmoPPool(gmo), nlevalconstants.data(), nlevalconstants.size() * sizeof(double)) != 0) )
+      {
+         delete nleval;
+         nleval = NULL;
+         setupEvaluator();
+      }
+
+      return;
+   }
+
+   delete[] iRowStart;
+   delete[] jCol;
+   delete[] jacval;
+   iRowStart = new int[m+1];
+   jCol      = new int[nele_jac];
+   jacval    = new double[nele_jac];
+
+   // keep the Jacobian values, as they stay constant for linear rows
+   gmoGetMatrixRow(gmo, iRowStart, jCol, jacval, NULL);
+   assert(iRowStart[m] == nele_jac);
+
+   // split rows into linear and nonlinear ones
+   delete[] linrows;
+   delete[] nlrows;
+   linrows = new int[m];
+   nlrows = new int[m];
+   nlinrows = 0;
+   nnlrows = 0;
+   int nz, qnz, nlnz;
+   for( int i = 0; i < m; ++i )
+   {
+      gmoGetRowStat(gmo, i, &nz, &qnz, &nlnz);
+      if( qnz + nlnz == 0 )
+         linrows[nlinrows++] = i;
+      else
+         nlrows[nnlrows++] = i;
+   }
+
+   delete[] grad;
+   grad = new double[n];
+
+   delete[] gcache;
+   gcache = new double[m];
+   delete[] jaccache;
+   jaccache = new double[nele_jac];
+   delete[] gradfcache;
+   gradfcache = new double[n];
+   gcachevalid = false;
+   fcachevalid = false;
+
+   if( sharedgmo == NULL )
+      delete nleval;
+   nleval = NULL;
+   if( paralleleval && nnlrows > 0 )
+      setupEvaluator();
+}
+
+std::unique_lock<std::mutex> GamsNLP::lockGmoAt(
+   const double*      x
+)
+{
+   std::unique_lock<std::mutex> lock(lockGmo());
+
+   // if GMO is shared, another thread may have evaluated at a different point since
+   if( newpoint || (sharedgmo != NULL && sharedgmo->point != this) )
+   {
+      gmoEvalNewPoint(gmo, x);
+      newpoint = false;
+      if( sharedgmo != NULL )
+         sharedgmo->point = this;
+   }
+
+   return lock;
+}
+
+void GamsNLP::setupEvaluator()
+{
+   if( sharedgmo != NULL && sharedgmo->nlevalready )
+   {
+      // a GamsNLP in another thread has set up the evaluator already
+      nleval = sharedgmo->nleval.get();
+   }
+   else
+   {
+      int n = gmoN(gmo);
+      char buffer[255];
+
+      nleval = new GamsNLEvaluator(gmo);
+      int ncompiled = nleval->compile(nnlrows, nlrows);
+      nlevalconstants.assign((double*)gmoPPool(gmo), (double*)gmoPPool(gmo) + gmoNLConst(gmo));
+
+      // values and gradients should match those of GMO, so compare at the starting point and at a point nearby
+      // this catches rows that are evaluated differently, but does not rule out rounding differences at other points
+      std::vector<double> x(n);
+      if( initx != NULL )
+         memcpy(x.data(), initx, n * sizeof(double));
+      else
+         gmoGetVarL(gmo, x.data());
+      int nmismatch = nleval->verify(x.data(), iRowStart, jCol);
+      for( int j = 0; j < n; ++j )
+         x[j] += 1e-3 * (1.0 + fabs(x[j]));
+      nmismatch += nleval->verify(x.data(), iRowStart, jCol);
+
+      // GMO has been moved to another point
+      gcachevalid = false;
+      fcachevalid = false;
+      newpoint = true;
+      if( sharedgmo != NULL )
+         sharedgmo->point = NULL;
+
+      sprintf(buffer, "Parallel evaluation: %d of %d nonlinear equations compiled, %d unsupported, %d mismatching GMO.",
+         nleval->getNRows(), nnlrows, nnlrows - ncompiled, nmismatch);
+      gevLog(gev, buffer);
+
+      if( nleval->getNRows() == 0 )
+      {
+         delete nleval;
+         nleval = NULL;
+      }
+
+      if( sharedgmo != NULL )
+      {
+         sharedgmo->nleval.reset(nleval);
+         sharedgmo->nlevalready = true;
+      }
+   }
+
+   if( nleval == NULL )
+      return;
+
+   // a shared evaluator is used with working memory of this NLP
+   if( sharedgmo != NULL )
+      nleval->initWorkspace(nlws);
+
+   // remember which nonlinear rows still need GMO
+   std::vector<bool> compiled(gmoM(gmo), false);
+   for( int i : nleval->getRows() )
+      compiled[i] = true;
+   nlgmorows.clear();
+   for( int r = 0; r < nnlrows; ++r )
+      if( !compiled[nlrows[r]] )
+         nlgmorows.push_back(nlrows[r]);
+}
+
+void GamsNLP::runPresolve()
+{
+   int n = gmoN(gmo);
+   int m = gmoM(gmo);
+
+   presolved = false;
+   psteps.clear();
+   psubst.clear();
+
+   setupJacobian();
+
+   std::vector<double> gl(m);
+   std::vector<double> gu(m);
+   pxl.resize(n);
+   pxu.resize(n);
+   if( !getBounds(pxl.data(), pxu.data(), gl.data(), gu.data()) )
+      return;
+
+   const double minf = gmoMinf(gmo);
+   const double pinf = gmoPinf(gmo);
+   // tolerance for deciding feasibility and redundancy of rows
+   auto eps = [](double val) { return 1e-9 * std::max(1.0, std::abs(val)); };
+
+   // substituting a column that appears nonlinearly would change the Hessian structure
+   std::vector<char> colnonlinear(n, 0);
+   int jnz, jqnz, jnlnz, jobjnz;
+   for( int j = 0; j < n; ++j )
+   {
+      gmoGetColStat(gmo, j, &jnz, &jqnz, &jnlnz, &jobjnz);
+      colnonlinear[j] = jqnz + jnlnz > 0 || jobjnz == 1;
+   }
+
+   std::vector<char> colremoved(n, 0);
+   std::vector<char> rowremoved(m, 0);
+   px.assign(n, 0.0);
+
+   int nfixed = 0;
+   int nbounds = 0;
+   int ndropped = 0;
+   bool changed = true;
+   for( int pass = 0; changed && pass < 10; ++pass )
+   {
+      changed = false;
+
+      // fixed columns
+      for( int j = 0; j < n; ++j )
+      {
+         if( colremoved[j] || pxl[j] != pxu[j] )
+            continue;
+         colremoved[j] = 1;
+         px[j] = pxl[j];
+         psteps.push_back(PresolveStep(PresolveStep::FIXCOL, j, -1, 0.0));
+         ++nfixed;
+         changed = true;
+      }
+
+      // linear rows that are empty, singletons, or redundant inequalities
+      for( int r = 0; r < nlinrows; ++r )
+      {
+         int i = linrows[r];
+         if( rowremoved[i] )
+            continue;
+
+         int nactive = 0;
+         int col = -1;
+         double coef = 0.0;
+         double constant = 0.0;
+         double minact = 0.0;
+         double maxact = 0.0;
+         bool mininf = false;
+         bool maxinf = false;
+         for( int k = iRowStart[i]; k < iRowStart[i+1]; ++k )
+         {
+            int j = jCol[k];
+            double a = jacval[k];
+            if( colremoved[j] )
+            {
+               constant += a * px[j];
+               continue;
+            }
+            if( a == 0.0 )
+               continue;
+            ++nactive;
+            col = j;
+            coef = a;
+            double lo = a > 0.0 ? pxl[j] : pxu[j];
+            double up = a > 0.0 ? pxu[j] : pxl[j];
+            if( lo <= minf || lo >= pinf )
+               mininf = true;
+            else
+               minact += a * lo;
+            if( up <= minf || up >= pinf )
+               maxinf = true;
+            else
+               maxact += a * up;
+         }
+
+         if( nactive == 0 )
+         {
+            // empty row: drop if satisfied, otherwise leave it to Ipopt to detect infeasibility
+            if( constant >= gl[i] - eps(gl[i]) && constant <= gu[i] + eps(gu[i]) )
+            {
+               rowremoved[i] = 1;
+               psteps.push_back(PresolveStep(PresolveStep::DROPROW, -1, i, 0.0));
+               ++ndropped;
+               changed = true;
+            }
+            continue;
+         }
+
+         if( nactive == 1 )
+         {
+            // singleton row: turn into bounds on its column
+            double lhs = gl[i] > minf ? (gl[i] - constant) / coef : (coef > 0.0 ? minf : pinf);
+            double rhs = gu[i] < pinf ? (gu[i] - constant) / coef : (coef > 0.0 ? pinf : minf);
+            double lb = coef > 0.0 ? lhs : rhs;
+            double ub = coef > 0.0 ? rhs : lhs;
+            if( lb > pxu[col] + eps(pxu[col]) || ub < pxl[col] - eps(pxl[col]) || lb > ub )
+               continue;
+
+            PresolveStep step(PresolveStep::BOUNDROW, col, i, coef);
+            if( lb > pxl[col] )
+            {
+               pxl[col] = std::min(lb, pxu[col]);
+               step.lbfromrow = true;
+            }
+            if( ub < pxu[col] )
+            {
+               pxu[col] = std::max(ub, pxl[col]);
+               step.ubfromrow = true;
+            }
+            rowremoved[i] = 1;
+            psteps.push_back(step);
+            ++nbounds;
+            changed = true;
+            continue;
+         }
+
+         // inequality that cannot be violated within the variable bounds
+         if( gl[i] != gu[i] &&
+             (gl[i] <= minf || (!mininf && minact >= gl[i] - eps(gl[i]))) &&
+             (gu[i] >= pinf || (!maxinf && maxact <= gu[i] + eps(gu[i]))) )
+         {
+            rowremoved[i] = 1;
+            psteps.push_back(PresolveStep(PresolveStep::DROPROW, -1, i, 0.0));
+            ++ndropped;
+            changed = true;
+         }
+      }
+   }
+
+   // linear equalities in two columns: substitute a free column that appears only linearly
+   // the other column must stay in the problem, so it is protected from being substituted later
+   std::vector<char> colissource(n, 0);
+   for( int r = 0; r < nlinrows; ++r )
+   {
+      int i = linrows[r];
+      if( rowremoved[i] || gl[i] != gu[i] )
+         continue;
+
+      int nactive = 0;
+      int cols[2];
+      double coefs[2];
+      double constant = 0.0;
+      bool substituted = false;
+      for( int k = iRowStart[i]; k < iRowStart[i+1] && nactive <= 2 && !substituted; ++k )
+      {
+         int j = jCol[k];
+         if( colremoved[j] )
+         {
+            // row with substituted column has more than two columns actually
+            substituted = pxl[j] != pxu[j];
+            constant += jacval[k] * px[j];
+            continue;
+         }
+         if( jacval[k] == 0.0 )
+            continue;
+         if( nactive < 2 )
+         {
+            cols[nactive] = j;
+            coefs[nactive] = jacval[k];
+         }
+         ++nactive;
+      }
+      if( substituted || nactive != 2 || cols[0] == cols[1] )
+         continue;
+
+      // choose column with larger coefficient for substitution, for numerical stability
+      int pick = -1;
+      double maxcoef = std::max(std::abs(coefs[0]), std::abs(coefs[1]));
+      for( int c = 0; c < 2; ++c )
+      {
+         int j = cols[c];
+         if( colnonlinear[j] || colissource[j] || pxl[j] > minf || pxu[j] < pinf )
+            continue;
+         if( std::abs(coefs[c]) < 1e-3 * maxcoef )
+            continue;
+         if( pick < 0 || std::abs(coefs[c]) > std::abs(coefs[pick]) )
+            pick = c;
+      }
+      if( pick < 0 )
+         continue;
+
+      PresolveStep step(PresolveStep::SUBSTCOL, cols[pick], i, coefs[pick]);
+      step.src = cols[1-pick];
+      step.offset = (gl[i] - constant) / coefs[pick];
+      step.factor = -coefs[1-pick] / coefs[pick];
+      colremoved[cols[pick]] = 1;
+      colissource[cols[1-pick]] = 1;
+      rowremoved[i] = 1;
+      psubst.push_back((int)psteps.size());
+      psteps.push_back(step);
+   }
+
+   if( psteps.empty() )
+      return;
+
+   // index maps between original and presolved NLP
+   pvarpos.assign(n, -1);
+   pvarmap.clear();
+   for( int j = 0; j < n; ++j )
+      if( !colremoved[j] )
+      {
+         pvarpos[j] = (int)pvarmap.size();
+         pvarmap.push_back(j);
+      }
+   prowpos.assign(m, -1);
+   prowmap.clear();
+   for( int i = 0; i < m; ++i )
+      if( !rowremoved[i] )
+      {
+         prowpos[i] = (int)prowmap.size();
+         prowmap.push_back(i);
+      }
+   pn = (int)pvarmap.size();
+   pm = (int)prowmap.size();
+
+   // leave a problem without variables to Ipopt as it is
+   if( pn == 0 )
+      return;
+
+   std::vector<int> substsrc(n, -1);
+   std::vector<double> substfactor(n, 0.0);
+   for( int s : psubst )
+   {
+      substsrc[psteps[s].col] = psteps[s].src;
+      substfactor[psteps[s].col] = psteps[s].factor;
+   }
+
+   // Jacobian of presolved NLP: drop fixed columns, map substituted columns onto their source column by the chain rule
+   pjacfrom.clear();
+   pjacto.clear();
+   pjacfactor.clear();
+   pjacrow.clear();
+   pjaccol.clear();
+   std::vector<int> colentry(pn, -1);
+   for( int ri = 0; ri < pm; ++ri )
+   {
+      int i = prowmap[ri];
+      int rowstart = (int)pjacrow.size();
+      for( int k = iRowStart[i]; k < iRowStart[i+1]; ++k )
+      {
+         int j = jCol[k];
+         int pj;
+         double factor = 1.0;
+         if( pvarpos[j] >= 0 )
+            pj = pvarpos[j];
+         else if( substsrc[j] >= 0 )
+         {
+            pj = pvarpos[substsrc[j]];
+            factor = substfactor[j];
+         }
+         else
+            continue;
+
+         if( colentry[pj] < rowstart )
+         {
+            colentry[pj] = (int)pjacrow.size();
+            pjacrow.push_back(ri);
+            pjaccol.push_back(pj);
+         }
+         pjacfrom.push_back(k);
+         pjacto.push_back(colentry[pj]);
+         pjacfactor.push_back(factor);
+      }
+   }
+
+   // Hessian of presolved NLP: drop entries of fixed columns; substituted columns appear only linearly
+   // the column order is kept, so the presolved Hessian stays lower-triangular
+   phessfrom.clear();
+   phessrow.clear();
+   phesscol.clear();
+   int nele_hess = gmoHessLagNz(gmo);
+   if( nele_hess > 0 )
+   {
+      std::vector<int> hessrow(nele_hess);
+      std::vector<int> hesscol(nele_hess);
+      gmoHessLagStruct(gmo, hessrow.data(), hesscol.data());
+      for( int k = 0; k < nele_hess; ++k )
+      {
+         if( pvarpos[hessrow[k]] < 0 || pvarpos[hesscol[k]] < 0 )
+            continue;
+         phessfrom.push_back(k);
+         phessrow.push_back(pvarpos[hessrow[k]]);
+         phesscol.push_back(pvarpos[hesscol[k]]);
+      }
+   }
+
+   pgrad.resize(n);
+   pg.resize(m);
+   pjac.resize(iRowStart[m]);
+   plambda.resize(m);
+   phess.resize(nele_hess);
+
+   presolved = true;
+
+   char buffer[255];
+   sprintf(buffer, "Presolve removed %d variables and %d constraints (%d fixed variables, %d singleton rows, %d empty or redundant rows, %d substitutions).\n",
+      n - pn, m - pm, nfixed, nbounds, ndropped, (int)psubst.size());
+   gevLogPChar(gev, buffer);
+}
+
+const double* GamsNLP::expandPoint(
+   const double*      x
+)
+{
+   assert(presolved);
+
+   for( int k = 0; k < pn; ++k )
+      px[pvarmap[k]] = x[k];
+   for( int s : psubst )
+      px[psteps[s].col] = psteps[s].offset + psteps[s].factor * px[psteps[s].src];
+
+   return px.data();
+}
+
+double GamsNLP::linearActivity(
+   int                row,
+   const double*      x
+)
+{
+   double val = 0.0;
+   for( int k = iRowStart[row]; k < iRowStart[row+1]; ++k )
+      val += jacval[k] * x[jCol[k]];
+   return val;
+}
+
+void GamsNLP::postsolve(
+   const double*      x,
+   const double*      z_L,
+   const double*      z_U,
+   const double*      lambda,
+   const double*      g,
+   std::vector<double>& xorig,
+   std::vector<double>& zlorig,
+   std::vector<double>& zuorig,
+   std::vector<double>& lambdaorig,
+   std::vector<double>& gorig
+)
+{
+   assert(presolved);
+
+   int n = gmoN(gmo);
+   int m = gmoM(gmo);
+
+   const double* xfull = expandPoint(x);
+   xorig.assign(xfull, xfull + n);
+
+   zlorig.assign(n, 0.0);
+   zuorig.assign(n, 0.0);
+   for( int k = 0; k < pn; ++k )
+   {
+      zlorig[pvarmap[k]] = z_L[k];
+      zuorig[pvarmap[k]] = z_U[k];
+   }
+
+   // removed rows are linear
+   lambdaorig.assign(m, 0.0);
+   gorig.resize(m);
+   for( int i = 0; i < m; ++i )
+      if( prowpos[i] >= 0 )
+      {
+         lambdaorig[i] = lambda[prowpos[i]];
+         gorig[i] = g[prowpos[i]];
+      }
+      else
+         gorig[i] = linearActivity(i, xorig.data());
+
+   // the dual values of removed columns and rows follow from stationarity of the Lagrangian, which requires derivatives at the solution
+   if( !evalGradF(xorig.data(), true, pgrad.data()) || !evalJacG(xorig.data(), false, pjac.data()) )
+      return;
+
+   // Jacobian by columns
+   int nele_jac = iRowStart[m];
+   std::vector<int> colstart(n+1, 0);
+   std::vector<int> colrow(nele_jac);
+   std::vector<int> colentry(nele_jac);
+   for( int k = 0; k < nele_jac; ++k )
+      ++colstart[jCol[k]+1];
+   for( int j = 0; j < n; ++j )
+      colstart[j+1] += colstart[j];
+   std::vector<int> fill(colstart.begin(), colstart.end()-1);
+   for( int i = 0; i < m; ++i )
+      for( int k = iRowStart[i]; k < iRowStart[i+1]; ++k )
+      {
+         colrow[fill[jCol[k]]] = i;
+         colentry[fill[jCol[k]]++] = k;
+      }
+
+   // derivative of Lagrangian w.r.t. column j without bound multipliers
+   auto reducedcost = [&](int j)
+   {
+      double d = pgrad[j];
+      for( int p = colstart[j]; p < colstart[j+1]; ++p )
+         d += lambdaorig[colrow[p]] * pjac[colentry[p]];
+      return d;
+   };
+
+   // undo reductions in reverse order
+   for( std::vector<PresolveStep>::const_reverse_iterator step = psteps.rbegin(); step != psteps.rend(); ++step )
+   {
+      switch( step->type )
+      {
+         case PresolveStep::FIXCOL:
+         {
+            double d = reducedcost(step->col);
+            zlorig[step->col] = std::max(d, 0.0);
+            zuorig[step->col] = std::max(-d, 0.0);
+            break;
+         }
+
+         case PresolveStep::DROPROW:
+            break;
+
+         case PresolveStep::BOUNDROW:
+            // multiplier of a bound that came from the row is the multiplier of the row
+            if( step->lbfromrow && zlorig[step->col] != 0.0 )
+            {
+               lambdaorig[step->row] -= zlorig[step->col] / step->coef;
+               zlorig[step->col] = 0.0;
+            }
+            if( step->ubfromrow && zuorig[step->col] != 0.0 )
+            {
+               lambdaorig[step->row] += zuorig[step->col] / step->coef;
+               zuorig[step->col] = 0.0;
+            }
+            break;
+
+         case PresolveStep::SUBSTCOL:
+            // substituted column is free, so the row multiplier makes its reduced cost vanish
+            lambdaorig[step->row] = -reducedcost(step->col) / step->coef;
+            break;
+      }
+   }
+}
+
+bool GamsNLP::getViolations(
+   const Ipopt::IpoptData* ip_data,
+   Ipopt::IpoptCalculatedQuantities* ip_cq,
+   double*            compl_x_L,
+   double*            compl_x_U,
+   double*            constr_viol,
+   double*            compl_g
+)
+{
+   int n = gmoN(gmo);
+   int m = gmoM(gmo);
+
+   if( !presolved )
+      return get_curr_violations(ip_data, ip_cq, false, n, NULL, NULL, compl_x_L, compl_x_U, NULL, m, constr_viol, compl_g);
+
+   // removed columns and rows count as satisfied
+   std::vector<double> cxl(pn);
+   std::vector<double> cxu(pn);
+   std::vector<double> viol(pm);
+   std::vector<double> cg(pm);
+   if( !get_curr_violations(ip_data, ip_cq, false, pn, NULL, NULL, cxl.data(), cxu.data(), NULL, pm, viol.data(), cg.data()) )
+      return false;
+
+   memset(compl_x_L, 0, n * sizeof(double));
+   memset(compl_x_U, 0, n * sizeof(double));
+   memset(constr_viol, 0, m * sizeof(double));
+   memset(compl_g, 0, m * sizeof(double));
+   for( int k = 0; k < pn; ++k )
+   {
+      compl_x_L[pvarmap[k]] = cxl[k];
+      compl_x_U[pvarmap[k]] = cxu[k];
+   }
+   for( int k = 0; k < pm; ++k )
+   {
+      constr_viol[prowmap[k]] = viol[k];
+      compl_g[prowmap[k]] = cg[k];
+   }
+
+   return true;
+}
+
 bool GamsNLP::get_nlp_info(
    Ipopt::Index&      n,
    Ipopt::Index&      m,
@@ -77,26 +1210,40 @@ bool GamsNLP::get_nlp_info(
    Ipopt::TNLP::IndexStyleEnum& Index_style
 )
 {
-   n           = gmoN(gmo);
-   m           = gmoM(gmo);
-   nnz_jac_g   = gmoNZ(gmo);
-   nnz_h_lag   = gmoHessLagNz(gmo);
+   std::unique_lock<std::mutex> gmolock(lockGmo());
+
+   // model data may have changed since a previous solve, so presolve again
+   presolved = false;
+   if( presolve )
+      runPresolve();
+
+   if( presolved )
+   {
+      n           = pn;
+      m           = pm;
+      nnz_jac_g   = (Ipopt::Index)pjacrow.size();
+      nnz_h_lag   = (Ipopt::Index)phessrow.size();
+   }
+   else
+   {
+      n           = gmoN(gmo);
+      m           = gmoM(gmo);
+      nnz_jac_g   = gmoNZ(gmo);
+      nnz_h_lag   = gmoHessLagNz(gmo);
+   }
    Index_style = C_STYLE;
 
    return true;
 }
 
-bool GamsNLP::get_bounds_info(
-   Ipopt::Index       n,
-   Ipopt::Number*     x_l,
-   Ipopt::Number*     x_u,
-   Ipopt::Index       m,
-   Ipopt::Number*     g_l,
-   Ipopt::Number*     g_u
+bool GamsNLP::getBounds(
+   double*            x_l,
+   double*            x_u,
+   double*            g_l,
+   double*            g_u
 )
 {
-   assert(n == gmoN(gmo));
-   assert(m == gmoM(gmo));
+   int m = gmoM(gmo);
 
    gmoGetVarLower(gmo, x_l);
    gmoGetVarUpper(gmo, x_u);
@@ -137,29 +1284,80 @@ bool GamsNLP::get_bounds_info(
    return true;
 }
 
-bool GamsNLP::get_starting_point(
+bool GamsNLP::get_bounds_info(
    Ipopt::Index       n,
+   Ipopt::Number*     x_l,
+   Ipopt::Number*     x_u,
+   Ipopt::Index       m,
+   Ipopt::Number*     g_l,
+   Ipopt::Number*     g_u
+)
+{
+   std::unique_lock<std::mutex> gmolock(lockGmo());
+
+   if( !presolved )
+   {
+      assert(n == gmoN(gmo));
+      assert(m == gmoM(gmo));
+
+      return getBounds(x_l, x_u, g_l, g_u);
+   }
+
+   assert(n == pn);
+   assert(m == pm);
+
+   std::vector<double> gl(gmoM(gmo));
+   std::vector<double> gu(gmoM(gmo));
+   std::vector<double> xl(gmoN(gmo));
+   std::vector<double> xu(gmoN(gmo));
+   if( !getBounds(xl.data(), xu.data(), gl.data(), gu.data()) )
+      return false;
+
+   // variable bounds may have been tightened by singleton rows
+   for( Index k = 0; k < n; ++k )
+   {
+      x_l[k] = pxl[pvarmap[k]];
+      x_u[k] = pxu[pvarmap[k]];
+   }
+   for( Index k = 0; k < m; ++k )
+   {
+      g_l[k] = gl[prowmap[k]];
+      g_u[k] = gu[prowmap[k]];
+   }
+
+   return true;
+}
+
+void GamsNLP::getStartingPoint(
    bool               init_x,
-   Ipopt::Number*     x,
+   double*            x,
    bool               init_z,
-   Ipopt::Number*     z_L,
-   Ipopt::Number*     z_U,
-   Ipopt::Index       m,
+   double*            z_L,
+   double*            z_U,
    bool               init_lambda,
-   Ipopt::Number*     lambda
+   double*            lambda
 )
 {
-   assert(n == gmoN(gmo));
-   assert(m == gmoM(gmo));
+   int n = gmoN(gmo);
+   int m = gmoM(gmo);
 
-   if( init_lambda )
+   if( init_lambda && initlambda != NULL )
+   {
+      memcpy(lambda, initlambda, m * sizeof(double));
+   }
+   else if( init_lambda )
    {
       gmoGetEquM(gmo, lambda);
       for( Index j = m; j; --j, ++lambda )
          *lambda *= -1;
    }
 
-   if( init_z )
+   if( init_z && initzl != NULL && initzu != NULL )
+   {
+      memcpy(z_L, initzl, n * sizeof(double));
+      memcpy(z_U, initzu, n * sizeof(double));
+   }
+   else if( init_z )
    {
       gmoGetVarM(gmo, z_L);
       for( Index j = n; j; --j, ++z_L, ++z_U )
@@ -176,7 +1374,10 @@ bool GamsNLP::get_starting_point(
 
    if( init_x )
    {
-      gmoGetVarL(gmo, x);
+      if( initx != NULL )
+         memcpy(x, initx, n * sizeof(double));
+      else
+         gmoGetVarL(gmo, x);
 
       // check that we are not above or below tolerance for diverging iterates
       for( Index j = 0;  j < n;  ++j )
@@ -197,6 +1398,66 @@ bool GamsNLP::get_starting_point(
          }
       }
    }
+}
+
+bool GamsNLP::get_starting_point(
+   Ipopt::Index       n,
+   bool               init_x,
+   Ipopt::Number*     x,
+   bool               init_z,
+   Ipopt::Number*     z_L,
+   Ipopt::Number*     z_U,
+   Ipopt::Index       m,
+   bool               init_lambda,
+   Ipopt::Number*     lambda
+)
+{
+   std::unique_lock<std::mutex> gmolock(lockGmo());
+
+   // model data may have changed since a previous solve, so forget cached function values
+   gcachevalid = false;
+   fcachevalid = false;
+
+   // coefficients of linear rows may have changed since a previous solve (e.g., GUSS), so refresh them
+   if( jacval != NULL )
+      gmoGetMatrixRow(gmo, iRowStart, jCol, jacval, NULL);
+
+   // same for quadratic coefficients
+   if( quadhess && quadhessstale )
+      setupQuadHessian(gmoHessLagNz(gmo));
+
+   if( !presolved )
+   {
+      assert(n == gmoN(gmo));
+      assert(m == gmoM(gmo));
+
+      getStartingPoint(init_x, x, init_z, z_L, z_U, init_lambda, lambda);
+
+      return true;
+   }
+
+   assert(n == pn);
+   assert(m == pm);
+
+   std::vector<double> xorig(gmoN(gmo));
+   std::vector<double> zlorig(gmoN(gmo));
+   std::vector<double> zuorig(gmoN(gmo));
+   std::vector<double> lambdaorig(gmoM(gmo));
+   getStartingPoint(init_x, xorig.data(), init_z, zlorig.data(), zuorig.data(), init_lambda, lambdaorig.data());
+
+   for( Index k = 0; k < n; ++k )
+   {
+      if( init_x )
+         x[k] = xorig[pvarmap[k]];
+      if( init_z )
+      {
+         z_L[k] = zlorig[pvarmap[k]];
+         z_U[k] = zuorig[pvarmap[k]];
+      }
+   }
+   if( init_lambda )
+      for( Index k = 0; k < m; ++k )
+         lambda[k] = lambdaorig[prowmap[k]];
 
    return true;
 }
@@ -212,6 +1473,8 @@ bool GamsNLP::get_var_con_metadata(
    NumericMetaDataMapType& con_numeric_md
 )
 {
+   std::unique_lock<std::mutex> gmolock(lockGmo());
+
    if( gmoDict(gmo) == NULL )
       return false;
 
@@ -224,7 +1487,7 @@ bool GamsNLP::get_var_con_metadata(
    varnames.reserve(n);
    for( Index i = 0; i < n; ++i )
    {
-      gmoGetVarNameOne(gmo, i, buffer);
+      gmoGetVarNameOne(gmo, presolved ? pvarmap[i] : i, buffer);
       varnames.push_back(buffer);
       namemem += strlen(buffer) + 1;
    }
@@ -233,7 +1496,7 @@ bool GamsNLP::get_var_con_metadata(
    connames.reserve(m);
    for( Index i = 0; i < m; ++i)
    {
-      gmoGetEquNameOne(gmo, i, buffer);
+      gmoGetEquNameOne(gmo, presolved ? prowmap[i] : i, buffer);
       connames.push_back(buffer);
       namemem += strlen(buffer) + 1;
    }
@@ -249,15 +1512,19 @@ bool GamsNLP::get_var_con_metadata(
 
 Ipopt::Index GamsNLP::get_number_of_nonlinear_variables()
 {
-   if( gmoNLNZ(gmo) == 0 && gmoObjNLNZ(gmo) == 0 )
+   std::unique_lock<std::mutex> gmolock(lockGmo());
+
+   if( linear )
       return 0; // problem is linear
 
    int count = 0;
    int jnz, jqnz, jnlnz, jobjnz;
    for( Index i = 0; i < gmoN(gmo); ++i )
    {
+      if( presolved && pvarpos[i] < 0 )
+         continue;
       gmoGetColStat(gmo, i, &jnz, &jqnz, &jnlnz, &jobjnz);
-      if( jnlnz > 0 || (jobjnz == 1) ) // jobjnz is -1 if linear in obj, +1 if nonlinear in obj, and 0 if not there
+      if( jqnz + jnlnz > 0 || (jobjnz == 1) ) // jobjnz is -1 if linear in obj, +1 if nonlinear in obj, and 0 if not there
          ++count;
    }
 
@@ -269,15 +1536,19 @@ bool GamsNLP::get_list_of_nonlinear_variables(
    Ipopt::Index*      pos_nonlin_vars
 )
 {
+   std::unique_lock<std::mutex> gmolock(lockGmo());
+
    int count = 0;
    int jnz, jqnz, jnlnz, jobjnz;
    for( int i = 0; i < gmoN(gmo); ++i )
    {
+      if( presolved && pvarpos[i] < 0 )
+         continue;
       gmoGetColStat(gmo, i, &jnz, &jqnz, &jnlnz, &jobjnz);
-      if( jnlnz > 0 || (jobjnz == 1) ) // jobjnz is -1 if linear in obj, +1 if nonlinear in obj, and 0 if not there
+      if( jqnz + jnlnz > 0 || (jobjnz == 1) ) // jobjnz is -1 if linear in obj, +1 if nonlinear in obj, and 0 if not there
       {
          assert(count < num_nonlin_vars);
-         pos_nonlin_vars[count++] = i;
+         pos_nonlin_vars[count++] = presolved ? pvarpos[i] : i;
       }
    }
    assert(count == num_nonlin_vars);
@@ -285,27 +1556,24 @@ bool GamsNLP::get_list_of_nonlinear_variables(
    return true;
 }
 
-bool GamsNLP::eval_f(
-   Ipopt::Index       n,
-   const Ipopt::Number* x,
-   bool               new_x,
-   Ipopt::Number&     obj_value
+bool GamsNLP::evalFAndGrad(
+   const double*      x
 )
 {
-   assert(n == gmoN(gmo));
+   assert(NULL != gradfcache);
 
-   if( new_x )
-   {
-      gmoEvalNewPoint(gmo, x);
-   }
+   std::unique_lock<std::mutex> gmolock(lockGmoAt(x));
 
+   memset(gradfcache, 0, gmoN(gmo)*sizeof(double));
+   fcachevalid = false;
+   double gx;
    int nerror;
-   int rc = gmoEvalFuncObj(gmo, x, &obj_value, &nerror);
+   int rc = gmoEvalGradObj(gmo, x, &fcache, gradfcache, &gx, &nerror);
 
    if( rc != 0 )
    {
       char buffer[255];
-      sprintf(buffer, "Critical error %d detected in evaluation of objective function!\n", rc);
+      sprintf(buffer, "Critical error %d detected in evaluation of objective gradient!\n", rc);
       throw std::runtime_error(buffer);
    }
 
@@ -315,6 +1583,92 @@ bool GamsNLP::eval_f(
       return false;
    }
 
+   fcachevalid = true;
+
+   return true;
+}
+
+bool GamsNLP::evalF(
+   const double*      x,
+   bool               new_x,
+   double&            obj_value
+)
+{
+   setNewX(new_x);
+
+   ++nevalf;
+
+   // objective value may be known from evaluating the objective gradient at the same point
+   if( fcachevalid )
+   {
+      ++nevalfcached;
+      obj_value = fcache;
+      return true;
+   }
+
+   if( gradfcache == NULL )
+   {
+      // structure not set up yet, so there is no place to keep the gradient
+      std::unique_lock<std::mutex> gmolock(lockGmoAt(x));
+      int nerror;
+      int rc = gmoEvalFuncObj(gmo, x, &obj_value, &nerror);
+
+      if( rc != 0 )
+      {
+         char buffer[255];
+         sprintf(buffer, "Critical error %d detected in evaluation of objective function!\n", rc);
+         throw std::runtime_error(buffer);
+      }
+
+      if( nerror > 0 )
+      {
+         ++domviolations;
+         return false;
+      }
+
+      return true;
+   }
+
+   // Ipopt asks for the gradient at a trial point after it has been accepted, so compute it together with the value
+   if( !evalFAndGrad(x) )
+      return false;
+   obj_value = fcache;
+
+   return true;
+}
+
+bool GamsNLP::eval_f(
+   Ipopt::Index       n,
+   const Ipopt::Number* x,
+   bool               new_x,
+   Ipopt::Number&     obj_value
+)
+{
+   GamsNLPEvalTimer evaltimer(profile ? &evaltiming[EVAL_F] : NULL);
+
+   assert(n == (presolved ? pn : gmoN(gmo)));
+
+   return evalF(presolved ? expandPoint(x) : x, new_x, obj_value);
+}
+
+bool GamsNLP::evalGradF(
+   const double*      x,
+   bool               new_x,
+   double*            grad_f
+)
+{
+   setNewX(new_x);
+
+   ++nevalgradf;
+
+   // objective gradient may be known from evaluating the objective function at the same point
+   if( fcachevalid )
+      ++nevalgradfcached;
+   else if( !evalFAndGrad(x) )
+      return false;
+
+   memcpy(grad_f, gradfcache, gmoN(gmo)*sizeof(double));
+
    return true;
 }
 
@@ -325,31 +1679,76 @@ bool GamsNLP::eval_grad_f(
    Ipopt::Number*    grad_f
 )
 {
-   assert(n == gmoN(gmo));
+   GamsNLPEvalTimer evaltimer(profile ? &evaltiming[EVAL_GRAD_F] : NULL);
 
-   if( new_x )
+   if( !presolved )
    {
-      gmoEvalNewPoint(gmo, x);
+      assert(n == gmoN(gmo));
+      return evalGradF(x, new_x, grad_f);
    }
 
-   memset(grad_f, 0, n*sizeof(double));
-   double val;
-   double gx;
-   int nerror;
-   int rc = gmoEvalGradObj(gmo, x, &val, grad_f, &gx, &nerror);
+   assert(n == pn);
+   if( !evalGradF(expandPoint(x), new_x, pgrad.data()) )
+      return false;
 
-   if( rc != 0 )
+   for( Index k = 0; k < n; ++k )
+      grad_f[k] = pgrad[pvarmap[k]];
+   // chain rule for substituted columns
+   for( int s : psubst )
+      grad_f[pvarpos[psteps[s].src]] += psteps[s].factor * pgrad[psteps[s].col];
+
+   return true;
+}
+
+bool GamsNLP::evalG(
+   const double*      x,
+   bool               new_x,
+   double*            g
+)
+{
+   int m = gmoM(gmo);
+
+   setNewX(new_x);
+
+   ++nevalg;
+
+   if( jacval == NULL )
    {
-      char buffer[255];
-      sprintf(buffer, "Critical error %d detected in evaluation of objective gradient!\n", rc);
-      throw std::runtime_error(buffer);
+      // Jacobian structure not known yet, so let GMO evaluate all rows
+      std::unique_lock<std::mutex> gmolock(lockGmoAt(x));
+      int nerror, rc;
+      for( int i = 0; i < m; ++i )
+      {
+         rc = gmoEvalFunc(gmo, i, x, &g[i], &nerror);
+         if( rc != 0 )
+         {
+            char buffer[255];
+            sprintf(buffer, "Critical error %d detected in evaluation of constraint %d!\n", rc, i);
+            throw std::runtime_error(buffer);
+         }
+         if( nerror > 0 )
+         {
+            ++domviolations;
+            return false;
+         }
+      }
+
+      return true;
    }
 
-   if( nerror > 0 )
-   {
-      ++domviolations;
+   // linear rows: sparse matrix-vector product with constant Jacobian values
+   for( int r = 0; r < nlinrows; ++r )
+      g[linrows[r]] = linearActivity(linrows[r], x);
+
+   // nonlinear rows: values may be known from evaluating the Jacobian at the same point
+   // otherwise, Ipopt asks for the Jacobian at a trial point after it has been accepted, so compute it together with the values
+   if( gcachevalid )
+      ++nevalgcached;
+   else if( !evalGAndJac(x) )
       return false;
-   }
+
+   for( int r = 0; r < nnlrows; ++r )
+      g[nlrows[r]] = gcache[nlrows[r]];
 
    return true;
 }
@@ -362,22 +1761,87 @@ bool GamsNLP::eval_g(
    Ipopt::Number*     g
 )
 {
-   assert(n == gmoN(gmo));
-   assert(m == gmoM(gmo));
+   GamsNLPEvalTimer evaltimer(profile ? &evaltiming[EVAL_G] : NULL);
 
-   if( new_x )
+   if( !presolved )
    {
-      gmoEvalNewPoint(gmo, x);
+      assert(n == gmoN(gmo));
+      assert(m == gmoM(gmo));
+      return evalG(x, new_x, g);
    }
 
+   assert(n == pn);
+   assert(m == pm);
+   if( !evalG(expandPoint(x), new_x, pg.data()) )
+      return false;
+
+   for( Index k = 0; k < m; ++k )
+      g[k] = pg[prowmap[k]];
+
+   return true;
+}
+
+bool GamsNLP::evalGAndJac(
+   const double*      x
+)
+{
+   assert(NULL != x);
+   assert(NULL != iRowStart);
+   assert(NULL != jCol);
+   assert(NULL != grad);
+   assert(NULL != gcache);
+   assert(NULL != jaccache);
+   assert(NULL != jacval);
+
+   double gx;
    int nerror, rc;
-   for( int i = 0; i < m; ++i )
+   int k;
+   int next;
+
+   // gradients of linear rows are constant, nonlinear rows are overwritten below
+   memcpy(jaccache, jacval, iRowStart[gmoM(gmo)] * sizeof(double));
+
+   gcachevalid = false;
+
+   // rows that the evaluator handles are evaluated without GMO, the others by GMO
+   const int* gmorows = nlrows;
+   int ngmorows = nnlrows;
+   if( nleval != NULL )
+   {
+      int nerrors = 0;
+      if( sharedgmo != NULL )
+      {
+         // the evaluator is shared with other threads, so evaluate row by row in this thread with our own working memory
+         for( int i : nleval->getRows() )
+            nerrors += nleval->evalRowGrad(i, x, nlws, gcache[i], iRowStart[i+1] - iRowStart[i], jCol + iRowStart[i], jaccache + iRowStart[i]);
+      }
+      else
+      {
+         // rows are evaluated in parallel
+         nerrors = nleval->evalGrad(x, gcache, iRowStart, jCol, jaccache);
+      }
+      if( nerrors > 0 )
+      {
+         ++domviolations;
+         return false;
+      }
+      gmorows = nlgmorows.data();
+      ngmorows = (int)nlgmorows.size();
+   }
+
+   // GMO is locked only if there are rows left for it
+   std::unique_lock<std::mutex> gmolock;
+   if( ngmorows > 0 )
+      gmolock = lockGmoAt(x);
+
+   for( int r = 0; r < ngmorows; ++r )
    {
-      rc = gmoEvalFunc(gmo, i, x, &g[i], &nerror);
+      int rownr = gmorows[r];
+      rc = gmoEvalGrad(gmo, rownr, x, &gcache[rownr], grad, &gx, &nerror);
       if( rc != 0 )
       {
          char buffer[255];
-         sprintf(buffer, "Critical error %d detected in evaluation of constraint %d!\n", rc, i);
+         sprintf(buffer, "Critical error %d detected in evaluation of gradient for constraint %d!\n", rc, rownr);
          throw std::runtime_error(buffer);
       }
       if( nerror > 0 )
@@ -385,8 +1849,37 @@ bool GamsNLP::eval_g(
          ++domviolations;
          return false;
       }
+      next = iRowStart[rownr+1];
+      for( k = iRowStart[rownr]; k < next; ++k )
+         jaccache[k] = grad[jCol[k]];
    }
 
+   gcachevalid = true;
+
+   return true;
+}
+
+bool GamsNLP::evalJacG(
+   const double*      x,
+   bool               new_x,
+   double*            values
+)
+{
+   assert(NULL != x);
+   assert(NULL != iRowStart);
+
+   setNewX(new_x);
+
+   ++nevaljacg;
+
+   // Jacobian may be known from evaluating the constraint functions at the same point
+   if( gcachevalid )
+      ++nevaljacgcached;
+   else if( !evalGAndJac(x) )
+      return false;
+
+   memcpy(values, jaccache, iRowStart[gmoM(gmo)] * sizeof(double));
+
    return true;
 }
 
@@ -401,9 +1894,20 @@ bool GamsNLP::eval_jac_g(
    Ipopt::Number*     values
 )
 {
-   assert(n == gmoN(gmo));
-   assert(m == gmoM(gmo));
-   assert(nele_jac == gmoNZ(gmo));
+   GamsNLPEvalTimer evaltimer(profile && values != NULL ? &evaltiming[EVAL_JAC_G] : NULL);
+
+   if( !presolved )
+   {
+      assert(n == gmoN(gmo));
+      assert(m == gmoM(gmo));
+      assert(nele_jac == gmoNZ(gmo));
+   }
+   else
+   {
+      assert(n == pn);
+      assert(m == pm);
+      assert(nele_jac == (Index)pjacrow.size());
+   }
 
    if( values == NULL )
    {
@@ -411,67 +1915,89 @@ bool GamsNLP::eval_jac_g(
       assert(NULL != iRow);
       assert(NULL != jCol);
 
-      delete[] iRowStart;
-      delete[] this->jCol;
-      iRowStart      = new int[m+1];
-      this->jCol     = new int[nele_jac];
-      double* jacval = new double[nele_jac];
-      
-      gmoGetMatrixRow(gmo, iRowStart, this->jCol, jacval, NULL);
+      if( presolved )
+      {
+         // presolve has set up the Jacobian already
+         memcpy(iRow, pjacrow.data(), nele_jac * sizeof(int));
+         memcpy(jCol, pjaccol.data(), nele_jac * sizeof(int));
+         return true;
+      }
+
+      std::unique_lock<std::mutex> gmolock(lockGmo());
+      setupJacobian();
+      gmolock.unlock();
 
-      assert(iRowStart[m] == nele_jac);
       for( Index i = 0; i < m; ++i )
          for( int j = iRowStart[i]; j < iRowStart[i+1]; ++j )
             iRow[j] = i;
       memcpy(jCol, this->jCol, nele_jac * sizeof(int));
 
-      delete[] jacval;
-
-      delete[] grad;
-      grad = new double[n];
+      return true;
    }
-   else
-   {
-      // compute values of Jacobian
-      assert(NULL != x);
-      assert(NULL == iRow);
-      assert(NULL == jCol);
-      assert(NULL != iRowStart);
-      assert(NULL != this->jCol);
-      assert(NULL != grad);
 
-      if( new_x )
-      {
-         gmoEvalNewPoint(gmo, x);
-      }
+   // compute values of Jacobian
+   assert(NULL == iRow);
+   assert(NULL == jCol);
 
-      double val;
-      double gx;
-      int nerror, rc;
-      int k;
-      int next;
+   if( !presolved )
+      return evalJacG(x, new_x, values);
+
+   if( !evalJacG(expandPoint(x), new_x, pjac.data()) )
+      return false;
+
+   // chain rule for substituted columns
+   memset(values, 0, nele_jac * sizeof(double));
+   for( size_t t = 0; t < pjacfrom.size(); ++t )
+      values[pjacto[t]] += pjacfactor[t] * pjac[pjacfrom[t]];
+
+   return true;
+}
+
+bool GamsNLP::evalH(
+   const double*      x,
+   bool               new_x,
+   double             obj_factor,
+   const double*      lambda,
+   double*            values
+)
+{
+   int m = gmoM(gmo);
 
-      k = 0;
-      for( int rownr = 0; rownr < m; ++rownr )
+   setNewX(new_x);
+
+   if( quadhess )
+   {
+      // Hessian of Lagrangian is a weighted sum of the constant Hessians of objective and constraints
+      memset(values, 0, gmoHessLagNz(gmo) * sizeof(double));
+      for( int k = 0; k < objqnz; ++k )
+         values[objqhesspos[k]] += obj_factor * objqcoef[k];
+      for( int i = 0; i < m; ++i )
       {
-         rc = gmoEvalGrad(gmo, rownr, x, &val, grad, &gx, &nerror);
-         if( rc != 0 )
-         {
-            char buffer[255];
-            sprintf(buffer, "Critical error %d detected in evaluation of gradient for constraint %d!\n", rc, rownr);
-            throw std::runtime_error(buffer);
-         }
-         if( nerror > 0 )
-         {
-            ++domviolations;
-            return false;
-         }
-         assert(k == iRowStart[rownr]);
-         next = iRowStart[rownr+1];
-         for( ; k < next; ++k )
-            values[k] = grad[this->jCol[k]];
+         if( lambda[i] == 0.0 )
+            continue;
+         for( int k = rowqstart[i]; k < rowqstart[i+1]; ++k )
+            values[rowqhesspos[k]] += lambda[i] * rowqcoef[k];
       }
-      assert(k == nele_jac);
+
+      return true;
+   }
+
+   std::unique_lock<std::mutex> gmolock(lockGmoAt(x));
+
+   // for GAMS, lambda would need to be multiplied by -1, we do this via the constraint weight
+   int nerror;
+   int rc;
+   rc = gmoHessLagValue(gmo, const_cast<double*>(x), const_cast<double*>(lambda), values, obj_factor, -1.0, &nerror);
+   if( rc != 0 )
+   {
+      char buffer[256];
+      sprintf(buffer, "Critical error detected %d in evaluation of Hessian!\n", rc);
+      throw std::runtime_error(buffer);
+   }
+   if( nerror > 0 )
+   {
+      ++domviolations;
+      return false;
    }
 
    return true;
@@ -491,9 +2017,20 @@ bool GamsNLP::eval_h(
    Ipopt::Number*     values
 )
 {
-   assert(n == gmoN(gmo));
-   assert(m == gmoM(gmo));
-   assert(nele_hess == gmoHessLagNz(gmo));
+   GamsNLPEvalTimer evaltimer(profile && values != NULL ? &evaltiming[EVAL_H] : NULL);
+
+   if( !presolved )
+   {
+      assert(n == gmoN(gmo));
+      assert(m == gmoM(gmo));
+      assert(nele_hess == gmoHessLagNz(gmo));
+   }
+   else
+   {
+      assert(n == pn);
+      assert(m == pm);
+      assert(nele_hess == (Index)phessrow.size());
+   }
 
    if( values == NULL )
    {
@@ -504,39 +2041,43 @@ bool GamsNLP::eval_h(
       assert(NULL != iRow);
       assert(NULL != jCol);
 
-      gmoHessLagStruct(gmo, iRow, jCol);
-   }
-   else
-   {
-      // compute hessian values
-      // this is a symmetric matrix, thus fill the lower left triangle only
-      assert(NULL != x);
-      assert(NULL != lambda);
-      assert(NULL == iRow);
-      assert(NULL == jCol);
+      std::unique_lock<std::mutex> gmolock(lockGmo());
 
-      if( new_x )
+      if( presolved )
       {
-         gmoEvalNewPoint(gmo, x);
+         memcpy(iRow, phessrow.data(), nele_hess * sizeof(int));
+         memcpy(jCol, phesscol.data(), nele_hess * sizeof(int));
       }
+      else
+         gmoHessLagStruct(gmo, iRow, jCol);
 
-      // for GAMS, lambda would need to be multiplied by -1, we do this via the constraint weight
-      int nerror;
-      int rc;
-      rc = gmoHessLagValue(gmo, const_cast<double*>(x), const_cast<double*>(lambda), values, obj_factor, -1.0, &nerror);
-      if( rc != 0 )
-      {
-         char buffer[256];
-         sprintf(buffer, "Critical error detected %d in evaluation of Hessian!\n", rc);
-         throw std::runtime_error(buffer);
-      }
-      if( nerror > 0 )
-      {
-         ++domviolations;
-         return false;
-      }
+      // for a purely quadratic model, we can assemble the Hessian from the quadratic coefficients
+      setupQuadHessian(gmoHessLagNz(gmo));
+
+      return true;
    }
 
+   // compute hessian values
+   // this is a symmetric matrix, thus fill the lower left triangle only
+   assert(NULL != x);
+   assert(NULL != lambda);
+   assert(NULL == iRow);
+   assert(NULL == jCol);
+
+   if( !presolved )
+      return evalH(x, new_x, obj_factor, lambda, values);
+
+   // removed rows are linear, so do not contribute to the Hessian
+   std::fill(plambda.begin(), plambda.end(), 0.0);
+   for( Index k = 0; k < m; ++k )
+      plambda[prowmap[k]] = lambda[k];
+
+   if( !evalH(expandPoint(x), new_x, obj_factor, plambda.data(), phess.data()) )
+      return false;
+
+   for( Index k = 0; k < nele_hess; ++k )
+      values[k] = phess[phessfrom[k]];
+
    return true;
 }
 
@@ -589,8 +2130,42 @@ bool GamsNLP::intermediate_callback(
 
       mininfeasiter = iter;
       mininfeasconviol = ip_cq->unscaled_curr_nlp_constraint_violation(NORM_MAX);
-      if( !get_curr_iterate(ip_data, ip_cq, false, gmoN(gmo), mininfeasprimals, mininfeasduallbs, mininfeasdualubs, gmoM(gmo), mininfeasactivity, mininfeasdualeqs) ||
-          !get_curr_violations(ip_data, ip_cq, false, gmoN(gmo), NULL, NULL, mininfeascomplxlb, mininfeascomplxub, NULL, gmoM(gmo), mininfeasviol, mininfeascomplg) )
+
+      bool success;
+      if( !presolved )
+         success = get_curr_iterate(ip_data, ip_cq, false, gmoN(gmo), mininfeasprimals, mininfeasduallbs, mininfeasdualubs, gmoM(gmo), mininfeasactivity, mininfeasdualeqs);
+      else
+      {
+         // map iterate back to original problem, but without recovering dual values of removed columns and rows
+         std::vector<double> x(pn);
+         std::vector<double> zl(pn);
+         std::vector<double> zu(pn);
+         std::vector<double> g(pm);
+         std::vector<double> lambda(pm);
+         success = get_curr_iterate(ip_data, ip_cq, false, pn, x.data(), zl.data(), zu.data(), pm, g.data(), lambda.data());
+         if( success )
+         {
+            memcpy(mininfeasprimals, expandPoint(x.data()), gmoN(gmo) * sizeof(double));
+            memset(mininfeasduallbs, 0, gmoN(gmo) * sizeof(double));
+            memset(mininfeasdualubs, 0, gmoN(gmo) * sizeof(double));
+            memset(mininfeasdualeqs, 0, gmoM(gmo) * sizeof(double));
+            for( int k = 0; k < pn; ++k )
+            {
+               mininfeasduallbs[pvarmap[k]] = zl[k];
+               mininfeasdualubs[pvarmap[k]] = zu[k];
+            }
+            for( int i = 0; i < gmoM(gmo); ++i )
+               if( prowpos[i] >= 0 )
+               {
+                  mininfeasactivity[i] = g[prowpos[i]];
+                  mininfeasdualeqs[i] = lambda[prowpos[i]];
+               }
+               else
+                  mininfeasactivity[i] = linearActivity(i, mininfeasprimals);
+         }
+      }
+
+      if( !success || !getViolations(ip_data, ip_cq, mininfeascomplxlb, mininfeascomplxub, mininfeasviol, mininfeascomplg) )
       {
          mininfeasiter = -1;  // forget given point if there was a problem; however, this should not happen in our setup
          mininfeasconviol = 1E+20;
@@ -614,20 +2189,89 @@ void GamsNLP::finalize_solution(
    Ipopt::IpoptCalculatedQuantities* cq
 )
 {
+   std::unique_lock<std::mutex> gmolock(lockGmo());
+
+   if( profile && data != NULL )
+   {
+      // remember how much time Ipopt spent overall and in the linear solver
+      TimingStatistics& timing = const_cast<IpoptData*>(data)->TimingStats();
+      ipopttotalwall = timing.OverallAlgorithm().TotalWallclockTime();
+      ipopttotalcpu = timing.OverallAlgorithm().TotalCpuTime();
+      ipoptlinsolwall = timing.LinearSystemSymbolicFactorization().TotalWallclockTime()
+         + timing.LinearSystemFactorization().TotalWallclockTime()
+         + timing.LinearSystemBackSolve().TotalWallclockTime();
+      ipoptlinsolcpu = timing.LinearSystemSymbolicFactorization().TotalCpuTime()
+         + timing.LinearSystemFactorization().TotalCpuTime()
+         + timing.LinearSystemBackSolve().TotalCpuTime();
+   }
+
+   // map solution of presolved NLP back to original NLP
+   std::vector<double> xorig;
+   std::vector<double> zlorig;
+   std::vector<double> zuorig;
+   std::vector<double> lambdaorig;
+   std::vector<double> gorig;
+   if( presolved )
+   {
+      assert(n == pn);
+      assert(m == pm);
+
+      // postsolve evaluates derivatives, which lock GMO themselves
+      if( gmolock.owns_lock() )
+         gmolock.unlock();
+      postsolve(x, z_L, z_U, lambda, g, xorig, zlorig, zuorig, lambdaorig, gorig);
+      gmolock = lockGmo();
+      n = gmoN(gmo);
+      m = gmoM(gmo);
+      x = xorig.data();
+      z_L = zlorig.data();
+      z_U = zuorig.data();
+      lambda = lambdaorig.data();
+      g = gorig.data();
+   }
+
    assert(n == gmoN(gmo));
    assert(m == gmoM(gmo));
 
+   if( storesol != NULL )
+   {
+      // only remember solution, leave it to the caller to decide what to pass on to GMO
+      storesol->valid = true;
+      storesol->status = status;
+      storesol->objval = obj_value;
+      storesol->conviol = cq != NULL ? cq->unscaled_curr_nlp_constraint_violation(NORM_MAX) : 0.0;
+      storesol->x.assign(x, x + n);
+      storesol->zl.assign(z_L, z_L + n);
+      storesol->zu.assign(z_U, z_U + n);
+      storesol->lambda.assign(lambda, lambda + m);
+      domviolations = 0;
+      return;
+   }
+
+   if( keepsol != NULL )
+   {
+      // remember locally optimal solution, so it may be reused if only parameters change
+      keepsol->valid = status == SUCCESS;
+      keepsol->status = status;
+      keepsol->objval = obj_value;
+      keepsol->conviol = cq != NULL ? cq->unscaled_curr_nlp_constraint_violation(NORM_MAX) : 0.0;
+      keepsol->x.assign(x, x + n);
+      keepsol->zl.assign(z_L, z_L + n);
+      keepsol->zu.assign(z_U, z_U + n);
+      keepsol->lambda.assign(lambda, lambda + m);
+   }
+
    bool write_solution = false;
    switch( status )
    {
       case SUCCESS:
-         gmoModelStatSet(gmo, (gmoObjNLNZ(gmo) || gmoNLNZ(gmo)) ? gmoModelStat_OptimalLocal : gmoModelStat_OptimalGlobal);
+         gmoModelStatSet(gmo, !linear ? gmoModelStat_OptimalLocal : gmoModelStat_OptimalGlobal);
          gmoSolveStatSet(gmo, gmoSolveStat_Normal);
          write_solution = true;
          break;
 
       case LOCAL_INFEASIBILITY:
-         gmoModelStatSet(gmo, (gmoObjNLNZ(gmo) || gmoNLNZ(gmo)) ? gmoModelStat_InfeasibleLocal : gmoModelStat_InfeasibleGlobal);
+         gmoModelStatSet(gmo, !linear ? gmoModelStat_InfeasibleLocal : gmoModelStat_InfeasibleGlobal);
          gmoSolveStatSet(gmo, gmoSolveStat_Normal);
          write_solution = true;
          break;
@@ -718,6 +2362,9 @@ void GamsNLP::finalize_solution(
    gmoSetHeadnTail(gmo, gmoHdomused, (double)domviolations);
    domviolations = 0;
 
+   // in case of a re-solve, the quadratic coefficients may have changed
+   quadhessstale = true;
+
    if( !write_solution )
       return;
 
@@ -767,7 +2414,7 @@ void GamsNLP::finalize_solution(
       compl_g = new double[m];
 
       // get detailed violations for column and row status
-      if( !get_curr_violations(data, cq, false, n, NULL, NULL, compl_xL, compl_xU, NULL, m, viol, compl_g) )
+      if( !getViolations(data, cq, compl_xL, compl_xU, viol, compl_g) )
       {
          // this should never happen
          memset(viol, 0, m*sizeof(double));
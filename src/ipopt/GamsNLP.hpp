@@ -8,10 +8,76 @@
 #define GAMSNLP_HPP_
 
 #include "IpTNLP.hpp"
+#include "GamsNLEval.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
 
 struct gmoRec;
 struct gevRec;
 
+/** a solution of the NLP as passed to finalize_solution, used when GamsNLP should not pass the solution to GMO */
+struct GamsNLPSolution
+{
+   bool                  valid;              /**< whether finalize_solution has been called */
+   Ipopt::SolverReturn   status;             /**< Ipopt solver return status */
+   double                objval;             /**< objective function value */
+   double                conviol;            /**< maximal unscaled constraint violation */
+   std::vector<double>   x;                  /**< primal values */
+   std::vector<double>   zl;                 /**< dual values for variable lower bounds */
+   std::vector<double>   zu;                 /**< dual values for variable upper bounds */
+   std::vector<double>   lambda;             /**< dual values for constraints */
+
+   GamsNLPSolution()
+   : valid(false),
+     status(Ipopt::UNASSIGNED),
+     objval(0.0),
+     conviol(0.0)
+   { }
+};
+
+/** call counts and timings for one kind of evaluation callback */
+struct GamsNLPEvalTiming
+{
+   /** number of histogram buckets for wall-clock time per call: <1us, <10us, <100us, <1ms, <10ms, <100ms, <1s, >=1s */
+   static const int      nbuckets = 8;
+
+   long int              ncalls;             /**< number of calls */
+   double                walltime;           /**< total wall-clock time */
+   double                cputime;            /**< total CPU time */
+   double                maxwalltime;        /**< maximal wall-clock time of a single call */
+   long int              histogram[nbuckets]; /**< number of calls by wall-clock time */
+
+   GamsNLPEvalTiming()
+   {
+      reset();
+   }
+
+   /** clears all counts and times */
+   void reset();
+
+   /** adds one call with given wall-clock and CPU time */
+   void add(
+      double             wall,               /**< wall-clock time of call */
+      double             cpu                 /**< CPU time of call */
+   );
+};
+
+/** state of a GMO that is shared by GamsNLPs that are solved concurrently in different threads */
+struct GamsNLPSharedGmo
+{
+   std::mutex            mutex;              /**< serializes calls into GMO */
+   const void*           point;              /**< GamsNLP at whose point GMO has been evaluated last, or NULL */
+   std::unique_ptr<GamsNLEvaluator> nleval;  /**< evaluator for nonlinear rows that is used by all GamsNLPs, or NULL */
+   bool                  nlevalready;        /**< whether the evaluator has been set up */
+
+   GamsNLPSharedGmo()
+   : point(NULL),
+     nlevalready(false)
+   { }
+};
+
 /** a TNLP for Ipopt that uses GMO to interface the problem formulation */
 class DllExport GamsNLP : public Ipopt::TNLP
 {
@@ -19,13 +85,67 @@ private:
    struct gmoRec*        gmo;                /**< GAMS modeling object */
    struct gevRec*        gev;                /**< GAMS environment */
 
+   bool                  linear;             /**< whether objective and constraints are linear */
+
    long int              domviollimit;       /**< domain violations limit */
    long int              domviolations;      /**< number of domain violations */
 
    int*                  iRowStart;          /**< row starts in Jacobian */
    int*                  jCol;               /**< column indices in Jacobian */
+   double*               jacval;             /**< Jacobian values at structure setup, constant for linear rows */
+   int*                  linrows;            /**< indices of linear rows */
+   int                   nlinrows;           /**< number of linear rows */
+   int*                  nlrows;             /**< indices of nonlinear rows */
+   int                   nnlrows;            /**< number of nonlinear rows */
    double*               grad;               /**< working memory for storing gradient values */
 
+   GamsNLEvaluator*      nleval;             /**< evaluator for nonlinear rows that does not use GMO, or NULL; owned by sharedgmo if that is set */
+   GamsNLEvaluator::Workspace nlws;          /**< working memory for nleval, if shared with GamsNLPs in other threads */
+   bool                  newpoint;           /**< whether Ipopt moved to a point that GMO has not been told about yet */
+   std::vector<int>      nlgmorows;          /**< nonlinear rows that need to be evaluated by GMO, if nleval is not NULL */
+   std::vector<double>   nlevalconstants;    /**< constants pool of GMO at the time nleval was set up */
+
+   bool                  quadhess;           /**< whether the Hessian is assembled from cached quadratic coefficients instead of by GMO */
+   bool                  quadhessstale;      /**< whether quadratic coefficients need to be retrieved again before next use */
+   int                   objqnz;             /**< number of quadratic coefficients in objective */
+   int*                  objqhesspos;        /**< position in Hessian of quadratic coefficients in objective */
+   double*               objqcoef;           /**< quadratic coefficients in objective */
+   int*                  rowqstart;          /**< start of quadratic coefficients of each row in rowqhesspos and rowqcoef */
+   int*                  rowqhesspos;        /**< position in Hessian of quadratic coefficients in rows */
+   double*               rowqcoef;           /**< quadratic coefficients in rows */
+
+   double*               gcache;             /**< nonlinear constraint values at the current point, computed together with jaccache */
+   double*               jaccache;           /**< Jacobian values at the current point, computed together with gcache */
+   bool                  gcachevalid;        /**< whether gcache and jaccache hold the values at the current point */
+   double                fcache;             /**< objective value at the current point, computed together with gradfcache */
+   double*               gradfcache;         /**< objective gradient at the current point, computed together with fcache */
+   bool                  fcachevalid;        /**< whether fcache and gradfcache hold the values at the current point */
+
+   long int              nevalf;             /**< number of calls to eval_f */
+   long int              nevalfcached;       /**< number of calls to eval_f answered from fcache */
+   long int              nevalg;             /**< number of calls to eval_g */
+   long int              nevalgcached;       /**< number of calls to eval_g answered from gcache */
+   long int              nevalgradf;         /**< number of calls to eval_grad_f */
+   long int              nevalgradfcached;   /**< number of calls to eval_grad_f answered from gradfcache */
+   long int              nevaljacg;          /**< number of calls to eval_jac_g for values */
+   long int              nevaljacgcached;    /**< number of calls to eval_jac_g answered from jaccache */
+
+   /** kinds of evaluation callbacks that are profiled */
+   enum EvalKind
+   {
+      EVAL_F = 0,
+      EVAL_GRAD_F,
+      EVAL_G,
+      EVAL_JAC_G,
+      EVAL_H,
+      EVAL_NKINDS
+   };
+   GamsNLPEvalTiming     evaltiming[EVAL_NKINDS]; /**< timings of evaluation callbacks, if profiling */
+   double                ipopttotalwall;     /**< wall-clock time of Ipopt algorithm, if profiling */
+   double                ipopttotalcpu;      /**< CPU time of Ipopt algorithm, if profiling */
+   double                ipoptlinsolwall;    /**< wall-clock time of Ipopt in linear solver, if profiling */
+   double                ipoptlinsolcpu;     /**< CPU time of Ipopt in linear solver, if profiling */
+
    int                   mininfeasiter;      /**< iteration number of minimal infeasible solution */
    double                mininfeasconviol;   /**< constraint violation in minimal infeasible solution */
    double*               mininfeasprimals;   /**< primal values in minimal infeasible solution */
@@ -38,11 +158,239 @@ private:
    double*               mininfeascomplxub;  /**< complementarity in variable upper bounds in minimal infeasible solution */
    double*               mininfeascomplg;    /**< complementarity in constraints in minimal infeasible solution */
 
+   /** a reduction done by presolve, remembered to map a solution back to the original NLP */
+   struct PresolveStep
+   {
+      enum Type
+      {
+         FIXCOL,                             /**< column is fixed, by its own bounds or by singleton rows */
+         DROPROW,                            /**< row is removed because it is empty or redundant */
+         BOUNDROW,                           /**< singleton row is turned into bounds on its column */
+         SUBSTCOL                            /**< column is substituted via a linear equality in two columns */
+      }                  type;
+      int                col;                /**< column that is fixed, bounded, or substituted, or -1 */
+      int                row;                /**< row that is removed, or -1 */
+      double             coef;               /**< coefficient of col in row */
+      bool               lbfromrow;          /**< whether the row gave the lower bound on col */
+      bool               ubfromrow;          /**< whether the row gave the upper bound on col */
+      int                src;                /**< column that col is expressed in, if substituted */
+      double             offset;             /**< offset in substitution col = offset + factor * src */
+      double             factor;             /**< factor in substitution col = offset + factor * src */
+
+      PresolveStep(
+         Type            type_,
+         int             col_,
+         int             row_,
+         double          coef_
+      )
+      : type(type_),
+        col(col_),
+        row(row_),
+        coef(coef_),
+        lbfromrow(false),
+        ubfromrow(false),
+        src(-1),
+        offset(0.0),
+        factor(0.0)
+      { }
+   };
+
+   bool                  presolved;          /**< whether Ipopt sees the presolved NLP */
+   int                   pn;                 /**< number of variables in presolved NLP */
+   int                   pm;                 /**< number of constraints in presolved NLP */
+   std::vector<int>      pvarmap;            /**< original index of each variable in presolved NLP */
+   std::vector<int>      prowmap;            /**< original index of each constraint in presolved NLP */
+   std::vector<int>      pvarpos;            /**< index in presolved NLP of each original variable, or -1 if removed */
+   std::vector<int>      prowpos;            /**< index in presolved NLP of each original constraint, or -1 if removed */
+   std::vector<double>   pxl;                /**< variable lower bounds after presolve */
+   std::vector<double>   pxu;                /**< variable upper bounds after presolve */
+   std::vector<PresolveStep> psteps;         /**< presolve reductions in the order they have been applied */
+   std::vector<int>      psubst;             /**< positions of substitutions in psteps */
+   std::vector<double>   px;                 /**< point in original variable space */
+   std::vector<double>   pgrad;              /**< objective gradient in original variable space */
+   std::vector<double>   pg;                 /**< constraint values of original NLP */
+   std::vector<double>   pjac;               /**< Jacobian values of original NLP */
+   std::vector<double>   plambda;            /**< constraint multipliers of original NLP */
+   std::vector<double>   phess;              /**< Hessian values of original NLP */
+   std::vector<int>      pjacfrom;           /**< position in original Jacobian of each term of presolved Jacobian */
+   std::vector<int>      pjacto;             /**< position in presolved Jacobian of each term */
+   std::vector<double>   pjacfactor;         /**< factor of each term of presolved Jacobian */
+   std::vector<int>      pjacrow;            /**< row indices of presolved Jacobian */
+   std::vector<int>      pjaccol;            /**< column indices of presolved Jacobian */
+   std::vector<int>      phessfrom;          /**< position in original Hessian of each entry of presolved Hessian */
+   std::vector<int>      phessrow;           /**< row indices of presolved Hessian */
+   std::vector<int>      phesscol;           /**< column indices of presolved Hessian */
+
+   /** sets up Jacobian structure and initial values and splits rows into linear and nonlinear ones
+    *
+    * If this has been done before, then only the values of the linear rows are updated and
+    * the evaluator is set up again if constants in the nonlinear instructions changed, as the structure stays the same.
+    */
+   void setupJacobian();
+
+   /** sets up the evaluator for nonlinear rows and checks that it gives the same values and gradients as GMO */
+   void setupEvaluator();
+
+   /** gets variable and constraint bounds of the original NLP from GMO */
+   bool getBounds(
+      double*            x_l,                /**< buffer for variable lower bounds */
+      double*            x_u,                /**< buffer for variable upper bounds */
+      double*            g_l,                /**< buffer for constraint lower bounds */
+      double*            g_u                 /**< buffer for constraint upper bounds */
+   );
+
+   /** gets starting point of the original NLP */
+   void getStartingPoint(
+      bool               init_x,             /**< whether to initialize primal values */
+      double*            x,                  /**< buffer for primal values */
+      bool               init_z,             /**< whether to initialize dual values of variable bounds */
+      double*            z_L,                /**< buffer for dual values of variable lower bounds */
+      double*            z_U,                /**< buffer for dual values of variable upper bounds */
+      bool               init_lambda,        /**< whether to initialize dual values of constraints */
+      double*            lambda              /**< buffer for dual values of constraints */
+   );
+
+   /** presolves the NLP: removes fixed columns, empty rows, and redundant linear inequalities,
+    *  turns singleton linear rows into bounds, and substitutes free linear columns via linear equalities in two columns
+    *
+    * Sets presolved to whether any reduction has been found.
+    */
+   void runPresolve();
+
+   /** maps a point of the presolved NLP into the original variable space, stored in px */
+   const double* expandPoint(
+      const double*      x                   /**< point of presolved NLP */
+   );
+
+   /** computes the activity of a linear row */
+   double linearActivity(
+      int                row,                /**< index of linear row */
+      const double*      x                   /**< point in original variable space */
+   );
+
+   /** maps a solution of the presolved NLP back to the original NLP
+    *
+    * Dual values of removed columns and rows are recovered from stationarity of the Lagrangian.
+    */
+   void postsolve(
+      const double*      x,                  /**< primal values of presolved NLP */
+      const double*      z_L,                /**< dual values of variable lower bounds of presolved NLP */
+      const double*      z_U,                /**< dual values of variable upper bounds of presolved NLP */
+      const double*      lambda,             /**< dual values of constraints of presolved NLP */
+      const double*      g,                  /**< constraint activities of presolved NLP */
+      std::vector<double>& xorig,            /**< buffer for primal values of original NLP */
+      std::vector<double>& zlorig,           /**< buffer for dual values of variable lower bounds of original NLP */
+      std::vector<double>& zuorig,           /**< buffer for dual values of variable upper bounds of original NLP */
+      std::vector<double>& lambdaorig,       /**< buffer for dual values of constraints of original NLP */
+      std::vector<double>& gorig             /**< buffer for constraint activities of original NLP */
+   );
+
+   /** gets complementarity and constraint violations at the current iterate for the original NLP */
+   bool getViolations(
+      const Ipopt::IpoptData* ip_data,       /**< Ipopt data */
+      Ipopt::IpoptCalculatedQuantities* ip_cq, /**< Ipopt calculated quantities */
+      double*            compl_x_L,          /**< buffer for complementarity of variable lower bounds */
+      double*            compl_x_U,          /**< buffer for complementarity of variable upper bounds */
+      double*            constr_viol,        /**< buffer for constraint violations */
+      double*            compl_g             /**< buffer for complementarity of constraints */
+   );
+
+   /** evaluates objective function and gradient of original NLP at the current point into fcache and gradfcache */
+   bool evalFAndGrad(
+      const double*      x
+   );
+
+   /** evaluates nonlinear constraint functions and Jacobian of original NLP at the current point into gcache and jaccache */
+   bool evalGAndJac(
+      const double*      x
+   );
+
+   /** evaluates objective function of original NLP */
+   bool evalF(
+      const double*      x,
+      bool               new_x,
+      double&            obj_value
+   );
+
+   /** evaluates objective gradient of original NLP */
+   bool evalGradF(
+      const double*      x,
+      bool               new_x,
+      double*            grad_f
+   );
+
+   /** evaluates constraint functions of original NLP */
+   bool evalG(
+      const double*      x,
+      bool               new_x,
+      double*            g
+   );
+
+   /** evaluates Jacobian of original NLP */
+   bool evalJacG(
+      const double*      x,
+      bool               new_x,
+      double*            values
+   );
+
+   /** evaluates Hessian of Lagrangian of original NLP */
+   bool evalH(
+      const double*      x,
+      bool               new_x,
+      double             obj_factor,
+      const double*      lambda,
+      double*            values
+   );
+
+   /** retrieves quadratic coefficients of objective and constraints from GMO and maps them onto the Hessian structure
+    *
+    * Sets quadhess to whether the model is purely quadratic and all coefficients could be mapped.
+    * Does nothing if GMO is not in Q mode.
+    */
+   void setupQuadHessian(
+      int                nele_hess           /**< number of nonzeros in Hessian */
+   );
+
+   /** locks GMO for exclusive use by this thread, if GMO is shared with other threads */
+   std::unique_lock<std::mutex> lockGmo()
+   {
+      return sharedgmo != NULL ? std::unique_lock<std::mutex>(sharedgmo->mutex) : std::unique_lock<std::mutex>();
+   }
+
+   /** locks GMO like lockGmo and makes sure GMO is at the point of this NLP */
+   std::unique_lock<std::mutex> lockGmoAt(
+      const double*      x                   /**< point of this NLP */
+   );
+
+   /** notes whether Ipopt moved to a new point, which invalidates cached values */
+   void setNewX(
+      bool               new_x               /**< whether the point is new */
+   )
+   {
+      if( new_x )
+      {
+         newpoint = true;
+         gcachevalid = false;
+         fcachevalid = false;
+      }
+   }
+
 public:
    double                div_iter_tol;       /**< value above which divergence is claimed */
    double                conviol_tol;        /**< constraint violation tolerance */
    double                compl_tol;          /**< complementarity tolerance */
    bool                  reportmininfeas;    /**< should an intermediate solution with minimal primal infeasibility be reported if final solution is not feasible? */
+   bool                  profile;            /**< whether to count and time evaluation callbacks */
+
+   GamsNLPSharedGmo*     sharedgmo;          /**< state of GMO if GMO is shared with GamsNLPs in other threads, or NULL */
+   const double*         initx;              /**< starting point for variables to use instead of GMO level values, or NULL */
+   const double*         initzl;             /**< starting point for dual values of variable lower bounds to use instead of GMO marginals, or NULL */
+   const double*         initzu;             /**< starting point for dual values of variable upper bounds to use instead of GMO marginals, or NULL */
+   const double*         initlambda;         /**< starting point for dual values of constraints to use instead of GMO marginals, or NULL */
+   GamsNLPSolution*      storesol;           /**< if not NULL, then finalize_solution stores the solution here instead of passing it to GMO */
+   GamsNLPSolution*      keepsol;            /**< if not NULL, then finalize_solution additionally stores the solution here, marked valid if locally optimal */
+   bool                  presolve;           /**< whether to presolve the NLP before passing it to Ipopt */
+   bool                  paralleleval;       /**< whether to evaluate nonlinear rows by GamsNLEvaluator instead of GMO, where possible */
 
    GamsNLP(
       struct gmoRec*     gmo_                /**< GAMS modeling object */
@@ -50,6 +398,48 @@ public:
 
    ~GamsNLP();
 
+   /** prints evaluation counts and cache hit rates into the log, if requested, and resets the counters */
+   void printEvalStatistics(
+      bool               print               /**< whether to print the counts */
+   );
+
+   /** prints a table with call counts and timings of evaluation callbacks into the log and resets them
+    *
+    * Requires profile to have been enabled during the solve.
+    * If jsonfile is not empty, then the profile is also written to this file in JSON format.
+    */
+   void printEvalProfile(
+      const std::string& jsonfile            /**< name of file to write profile to, or empty */
+   );
+
+   /** checks whether a solution of a previous solve is still a KKT point of the current, possibly modified, problem
+    *
+    * Returns 1 if the point satisfies the KKT conditions w.r.t. tolerances tol (dual infeasibility) and conviol_tol,
+    * 0 if it does not, but it is still feasible for all bounds and constraints that were inactive,
+    * and -1 if it violates a previously inactive bound or constraint, i.e., the active set changes, or evaluation failed.
+    * Stores the constraint activities at the point in activity.
+    */
+   int checkKKTPoint(
+      const GamsNLPSolution& sol,            /**< solution of previous solve */
+      double             tol,                /**< tolerance on dual infeasibility */
+      std::vector<double>& activity          /**< buffer to store constraint activities */
+   );
+
+   /** passes a solution that has been verified by checkKKTPoint to GMO as locally optimal */
+   void reportKKTPoint(
+      const GamsNLPSolution& sol,            /**< solution to report */
+      const std::vector<double>& activity    /**< constraint activities at solution */
+   );
+
+   /** gives the wall-clock time that Ipopt spent in the linear solver in the last solve
+    *
+    * Requires profile to have been enabled during the solve.
+    */
+   double getLinearSolverTime() const
+   {
+      return ipoptlinsolwall;
+   }
+
    bool get_nlp_info(
       Ipopt::Index&      n,
       Ipopt::Index&      m,
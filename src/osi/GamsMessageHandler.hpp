@@ -37,6 +37,12 @@ public:
      mutex(mutex_)
    { }
 
+   /** gives the mutex that syncs gevLog calls of this message handler and its clones */
+   std::shared_ptr<std::mutex> getMutex() const
+   {
+      return mutex;
+   }
+
    /** sets detail level of current message */
    void setCurrentDetail(
       int                detail              /**< new detail level */
@@ -76,6 +76,20 @@ struct SCIP_ProbData
    SCIP_VAR*             objconst;           /**< SCIP variable used to model objective constant */
 };
 
+/** linear combination of expressions that is collected for a run of additions, subtractions, and scalings in makeExpr,
+ * before a SCIP sum expression is created for it
+ */
+struct SumAcc
+{
+   SCIP_EXPR**           children;           /**< children, each one captured by the accumulator */
+   SCIP_Real*            coefs;              /**< coefficients of children, to be multiplied by scale */
+   int                   nchildren;          /**< number of children */
+   int                   childrensize;       /**< length of children and coefs arrays */
+   SCIP_Real             constant;           /**< constant term, to be multiplied by scale */
+   SCIP_Real             scale;              /**< factor on all coefficients and the constant, never zero */
+};
+typedef struct SumAcc SUMACC;
+
 /*
  * Callback methods of probdata
  */
@@ -258,6 +272,379 @@ SCIP_RETCODE exprAdd(
    return SCIP_OKAY;
 }
 
+/** creates an empty sum accumulator */
+static
+SCIP_RETCODE sumaccCreate(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SUMACC**              acc                 /**< pointer to store accumulator */
+)
+{
+   assert(acc != NULL);
+
+   SCIP_CALL( SCIPallocBlockMemory(scip, acc) );
+   (*acc)->children = NULL;
+   (*acc)->coefs = NULL;
+   (*acc)->nchildren = 0;
+   (*acc)->childrensize = 0;
+   (*acc)->constant = 0.0;
+   (*acc)->scale = 1.0;
+
+   return SCIP_OKAY;
+}
+
+/** frees a sum accumulator, releasing its children if requested */
+static
+SCIP_RETCODE sumaccFree(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SUMACC**              acc,                /**< accumulator to free */
+   SCIP_Bool             releasechildren     /**< whether the children should be released */
+)
+{
+   int i;
+
+   assert(acc != NULL);
+   assert(*acc != NULL);
+
+   if( releasechildren )
+      for( i = 0; i < (*acc)->nchildren; ++i )
+      {
+         SCIP_CALL( SCIPreleaseExpr(scip, &(*acc)->children[i]) );
+      }
+
+   SCIPfreeBlockMemoryArrayNull(scip, &(*acc)->children, (*acc)->childrensize);
+   SCIPfreeBlockMemoryArrayNull(scip, &(*acc)->coefs, (*acc)->childrensize);
+   SCIPfreeBlockMemory(scip, acc);
+
+   return SCIP_OKAY;
+}
+
+/** ensures space for additional children in a sum accumulator */
+static
+SCIP_RETCODE sumaccEnsureSize(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SUMACC*               acc,                /**< accumulator */
+   int                   num                 /**< number of children that need to fit */
+)
+{
+   int newsize;
+
+   if( num <= acc->childrensize )
+      return SCIP_OKAY;
+
+   newsize = SCIPcalcMemGrowSize(scip, num);
+   SCIP_CALL( SCIPreallocBlockMemoryArray(scip, &acc->children, acc->childrensize, newsize) );
+   SCIP_CALL( SCIPreallocBlockMemoryArray(scip, &acc->coefs, acc->childrensize, newsize) );
+   acc->childrensize = newsize;
+
+   return SCIP_OKAY;
+}
+
+/** multiplies a sum accumulator by a constant */
+static
+SCIP_RETCODE sumaccScale(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SUMACC*               acc,                /**< accumulator */
+   SCIP_Real             factor              /**< factor */
+)
+{
+   int i;
+
+   if( factor != 0.0 )
+   {
+      acc->scale *= factor;
+      return SCIP_OKAY;
+   }
+
+   for( i = 0; i < acc->nchildren; ++i )
+   {
+      SCIP_CALL( SCIPreleaseExpr(scip, &acc->children[i]) );
+   }
+   acc->nchildren = 0;
+   acc->constant = 0.0;
+   acc->scale = 1.0;
+
+   return SCIP_OKAY;
+}
+
+/** adds coef times an expression to a sum accumulator, taking over the reference to the expression
+ *
+ * Values are added to the constant and sums are flattened into the accumulator.
+ */
+static
+SCIP_RETCODE sumaccAddTerm(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SUMACC*               acc,                /**< accumulator */
+   SCIP_Real             coef,               /**< coefficient of term */
+   SCIP_EXPR*            term                /**< expression of term */
+)
+{
+   assert(acc != NULL);
+   assert(term != NULL);
+
+   coef /= acc->scale;
+
+   if( SCIPisExprValue(scip, term) )
+   {
+      acc->constant += coef * SCIPgetValueExprValue(term);
+   }
+   else if( SCIPisExprSum(scip, term) )
+   {
+      SCIP_EXPR** children;
+      SCIP_Real* coefs;
+      int nchildren;
+      int i;
+
+      children = SCIPexprGetChildren(term);
+      coefs = SCIPgetCoefsExprSum(term);
+      nchildren = SCIPexprGetNChildren(term);
+
+      SCIP_CALL( sumaccEnsureSize(scip, acc, acc->nchildren + nchildren) );
+      for( i = 0; i < nchildren; ++i )
+      {
+         SCIPcaptureExpr(children[i]);
+         acc->children[acc->nchildren] = children[i];
+         acc->coefs[acc->nchildren] = coef * coefs[i];
+         ++acc->nchildren;
+      }
+      acc->constant += coef * SCIPgetConstantExprSum(term);
+   }
+   else
+   {
+      SCIP_CALL( sumaccEnsureSize(scip, acc, acc->nchildren + 1) );
+      acc->children[acc->nchildren] = term;
+      acc->coefs[acc->nchildren] = coef;
+      ++acc->nchildren;
+
+      return SCIP_OKAY;
+   }
+
+   SCIP_CALL( SCIPreleaseExpr(scip, &term) );
+
+   return SCIP_OKAY;
+}
+
+/** adds coef times a sum accumulator to another one and frees the added accumulator */
+static
+SCIP_RETCODE sumaccAddSum(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SUMACC*               acc,                /**< accumulator to add to */
+   SCIP_Real             coef,               /**< coefficient of other accumulator */
+   SUMACC**              other               /**< accumulator to add, freed */
+)
+{
+   SCIP_Real factor;
+   int i;
+
+   assert(acc != NULL);
+   assert(other != NULL);
+   assert(*other != NULL);
+
+   factor = coef * (*other)->scale / acc->scale;
+
+   SCIP_CALL( sumaccEnsureSize(scip, acc, acc->nchildren + (*other)->nchildren) );
+   for( i = 0; i < (*other)->nchildren; ++i )
+   {
+      acc->children[acc->nchildren] = (*other)->children[i];
+      acc->coefs[acc->nchildren] = factor * (*other)->coefs[i];
+      ++acc->nchildren;
+   }
+   acc->constant += factor * (*other)->constant;
+
+   /* the references to the children have been moved to acc */
+   SCIP_CALL( sumaccFree(scip, other, FALSE) );
+
+   return SCIP_OKAY;
+}
+
+/** creates an expression for a sum accumulator and frees the accumulator
+ *
+ * Terms of the same variable are merged and terms with zero coefficient are dropped.
+ */
+static
+SCIP_RETCODE sumaccCreateExpr(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SUMACC**              acc,                /**< accumulator, freed */
+   SCIP_EXPR**           expr                /**< pointer to store expression */
+)
+{
+   SCIP_EXPR** children;
+   SCIP_Real* coefs;
+   int nchildren;
+   int nvarterms;
+   int i;
+
+   assert(acc != NULL);
+   assert(*acc != NULL);
+   assert(expr != NULL);
+
+   children = (*acc)->children;
+   coefs = (*acc)->coefs;
+   nchildren = (*acc)->nchildren;
+
+   /* merge terms of the same variable */
+   nvarterms = 0;
+   for( i = 0; i < nchildren; ++i )
+      if( SCIPisExprVar(scip, children[i]) )
+         ++nvarterms;
+
+   if( nvarterms > 1 )
+   {
+      int* varidx;
+      int* varpos;
+      int keep;
+
+      SCIP_CALL( SCIPallocBufferArray(scip, &varidx, nvarterms) );
+      SCIP_CALL( SCIPallocBufferArray(scip, &varpos, nvarterms) );
+
+      nvarterms = 0;
+      for( i = 0; i < nchildren; ++i )
+         if( SCIPisExprVar(scip, children[i]) )
+         {
+            varidx[nvarterms] = SCIPvarGetIndex(SCIPgetVarExprVar(children[i]));
+            varpos[nvarterms] = i;
+            ++nvarterms;
+         }
+
+      SCIPsortIntInt(varidx, varpos, nvarterms);
+
+      keep = varpos[0];
+      for( i = 1; i < nvarterms; ++i )
+      {
+         if( varidx[i] != varidx[i-1] )
+         {
+            keep = varpos[i];
+            continue;
+         }
+         coefs[keep] += coefs[varpos[i]];
+         coefs[varpos[i]] = 0.0;
+      }
+
+      SCIPfreeBufferArray(scip, &varpos);
+      SCIPfreeBufferArray(scip, &varidx);
+   }
+
+   /* drop terms with zero coefficient and apply scale */
+   nchildren = 0;
+   for( i = 0; i < (*acc)->nchildren; ++i )
+   {
+      if( coefs[i] == 0.0 )
+      {
+         SCIP_CALL( SCIPreleaseExpr(scip, &children[i]) );
+         continue;
+      }
+      children[nchildren] = children[i];
+      coefs[nchildren] = (*acc)->scale * coefs[i];
+      ++nchildren;
+   }
+   (*acc)->nchildren = nchildren;
+
+   if( nchildren == 0 )
+   {
+      SCIP_CALL( SCIPcreateExprValue(scip, expr, (*acc)->scale * (*acc)->constant, NULL, NULL) );
+   }
+   else if( nchildren == 1 && coefs[0] == 1.0 && (*acc)->constant == 0.0 )
+   {
+      /* take over the reference to the only child */
+      *expr = children[0];
+      (*acc)->nchildren = 0;
+   }
+   else
+   {
+      SCIP_CALL( SCIPcreateExprSum(scip, expr, nchildren, children, coefs, (*acc)->scale * (*acc)->constant, NULL, NULL) );
+   }
+
+   SCIP_CALL( sumaccFree(scip, acc, TRUE) );
+
+   return SCIP_OKAY;
+}
+
+/** ensures that an entry of the operand stack of makeExpr is given as sum accumulator */
+static
+SCIP_RETCODE stackGetSum(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SCIP_EXPR**           stack,              /**< expressions on stack, NULL where an accumulator is */
+   SUMACC**              accs,               /**< accumulators on stack, NULL where an expression is */
+   int                   pos                 /**< position of entry */
+)
+{
+   if( accs[pos] != NULL )
+      return SCIP_OKAY;
+
+   SCIP_CALL( sumaccCreate(scip, &accs[pos]) );
+   SCIP_CALL( sumaccAddTerm(scip, accs[pos], 1.0, stack[pos]) );
+   stack[pos] = NULL;
+
+   return SCIP_OKAY;
+}
+
+/** ensures that an entry of the operand stack of makeExpr is given as expression */
+static
+SCIP_RETCODE stackGetExpr(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SCIP_EXPR**           stack,              /**< expressions on stack, NULL where an accumulator is */
+   SUMACC**              accs,               /**< accumulators on stack, NULL where an expression is */
+   int                   pos                 /**< position of entry */
+)
+{
+   if( accs[pos] == NULL )
+      return SCIP_OKAY;
+
+   SCIP_CALL( sumaccCreateExpr(scip, &accs[pos], &stack[pos]) );
+
+   return SCIP_OKAY;
+}
+
+/** replaces the two topmost entries of the operand stack of makeExpr by a sum accumulator for coefbelow * below + coeftop * top
+ *
+ * The shorter operand is added to the longer one.
+ */
+static
+SCIP_RETCODE stackAddTop(
+   SCIP*                 scip,               /**< SCIP data structure */
+   SCIP_EXPR**           stack,              /**< expressions on stack, NULL where an accumulator is */
+   SUMACC**              accs,               /**< accumulators on stack, NULL where an expression is */
+   int*                  stackpos,           /**< number of entries on stack */
+   SCIP_Real             coefbelow,          /**< coefficient of second entry from top */
+   SCIP_Real             coeftop             /**< coefficient of topmost entry */
+)
+{
+   int top;
+   int below;
+
+   assert(*stackpos >= 2);
+
+   top = *stackpos-1;
+   below = top-1;
+
+   if( accs[top] != NULL && (accs[below] == NULL || accs[top]->nchildren > accs[below]->nchildren) )
+   {
+      SCIP_Real tmp;
+
+      SCIPswapPointers((void**)&stack[top], (void**)&stack[below]);
+      SCIPswapPointers((void**)&accs[top], (void**)&accs[below]);
+      tmp = coeftop;
+      coeftop = coefbelow;
+      coefbelow = tmp;
+   }
+
+   SCIP_CALL( stackGetSum(scip, stack, accs, below) );
+   SCIP_CALL( sumaccScale(scip, accs[below], coefbelow) );
+
+   if( accs[top] != NULL )
+   {
+      SCIP_CALL( sumaccAddSum(scip, accs[below], coeftop, &accs[top]) );
+   }
+   else
+   {
+      SCIP_CALL( sumaccAddTerm(scip, accs[below], coeftop, stack[top]) );
+      stack[top] = NULL;
+   }
+
+   --*stackpos;
+
+   return SCIP_OKAY;
+}
+
 /** creates an expression from given GAMS nonlinear instructions */
 static
 SCIP_RETCODE makeExpr(
@@ -273,6 +660,7 @@ SCIP_RETCODE makeExpr(
 {
    SCIP_PROBDATA* probdata;
    SCIP_EXPR**   stack;
+   SUMACC**      accs;
    int           stackpos;
    int           stacksize;
    int           pos;
@@ -282,6 +670,7 @@ SCIP_RETCODE makeExpr(
    GamsOpCode    opcode;
    int           address;
    int           nargs;
+   int           i;
    SCIP_RETCODE  rc;
 
    assert(scip != NULL);
@@ -298,6 +687,7 @@ SCIP_RETCODE makeExpr(
    stackpos = 0;
    stacksize = 20;
    SCIP_CALL( SCIPallocBufferArray(scip, &stack, stacksize) );
+   SCIP_CALL( SCIPallocBufferArray(scip, &accs, stacksize) );
 
    nargs = -1;
    rc = SCIP_OKAY;
@@ -350,12 +740,8 @@ SCIP_RETCODE makeExpr(
          {
             SCIPdebugPrintf("add\n");
             assert(stackpos >= 2);
-            term1 = stack[stackpos-1];
-            --stackpos;
-            term2 = stack[stackpos-1];
-            --stackpos;
 
-            SCIP_CALL( exprAdd(scip, &e, 1.0, term1, 1.0, term2, 0.0) );
+            SCIP_CALL( stackAddTop(scip, stack, accs, &stackpos, 1.0, 1.0) );
 
             break;
          }
@@ -366,11 +752,10 @@ SCIP_RETCODE makeExpr(
             SCIPdebugPrintf("add variable %d = <%s>\n", address, SCIPvarGetName(probdata->vars[address]));
 
             assert(stackpos >= 1);
-            term1 = stack[stackpos-1];
-            --stackpos;
+            SCIP_CALL( stackGetSum(scip, stack, accs, stackpos-1) );
 
             SCIP_CALL( SCIPcreateExprVar(scip, &term2, probdata->vars[address], NULL, NULL) );
-            SCIP_CALL( exprAdd(scip, &e, 1.0, term1, 1.0, term2, 0.0) );
+            SCIP_CALL( sumaccAddTerm(scip, accs[stackpos-1], 1.0, term2) );
 
             break;
          }
@@ -380,10 +765,9 @@ SCIP_RETCODE makeExpr(
             SCIPdebugPrintf("add constant %g\n", constants[address]);
 
             assert(stackpos >= 1);
-            term1 = stack[stackpos-1];
-            --stackpos;
+            SCIP_CALL( stackGetSum(scip, stack, accs, stackpos-1) );
 
-            SCIP_CALL( exprAdd(scip, &e, 1.0, term1, 1.0, NULL, constants[address]) );
+            accs[stackpos-1]->constant += constants[address] / accs[stackpos-1]->scale;
 
             break;
          }
@@ -393,12 +777,8 @@ SCIP_RETCODE makeExpr(
             SCIPdebugPrintf("subtract\n");
 
             assert(stackpos >= 2);
-            term1 = stack[stackpos-1];
-            --stackpos;
-            term2 = stack[stackpos-1];
-            --stackpos;
 
-            SCIP_CALL( exprAdd(scip, &e, 1.0, term2, -1.0, term1, 0.0) );
+            SCIP_CALL( stackAddTop(scip, stack, accs, &stackpos, 1.0, -1.0) );
 
             break;
          }
@@ -409,11 +789,10 @@ SCIP_RETCODE makeExpr(
             SCIPdebugPrintf("subtract variable %d = <%s>\n", address, SCIPvarGetName(probdata->vars[address]));
 
             assert(stackpos >= 1);
-            term1 = stack[stackpos-1];
-            --stackpos;
+            SCIP_CALL( stackGetSum(scip, stack, accs, stackpos-1) );
 
             SCIP_CALL( SCIPcreateExprVar(scip, &term2, probdata->vars[address], NULL, NULL) );
-            SCIP_CALL( exprAdd(scip, &e, 1.0, term1, -1.0, term2, 0.0) );
+            SCIP_CALL( sumaccAddTerm(scip, accs[stackpos-1], -1.0, term2) );
 
             break;
          }
@@ -423,10 +802,9 @@ SCIP_RETCODE makeExpr(
             SCIPdebugPrintf("subtract constant %g\n", constants[address]);
 
             assert(stackpos >= 1);
-            term1 = stack[stackpos-1];
-            --stackpos;
+            SCIP_CALL( stackGetSum(scip, stack, accs, stackpos-1) );
 
-            SCIP_CALL( exprAdd(scip, &e, 1.0, term1, 1.0, NULL, -constants[address]) );
+            accs[stackpos-1]->constant -= constants[address] / accs[stackpos-1]->scale;
 
             break;
          }
@@ -437,8 +815,10 @@ SCIP_RETCODE makeExpr(
             SCIPdebugPrintf("multiply\n");
 
             assert(stackpos >= 2);
+            SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
             terms[1] = stack[stackpos-1];
             --stackpos;
+            SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
             terms[0] = stack[stackpos-1];
             --stackpos;
 
@@ -457,6 +837,7 @@ SCIP_RETCODE makeExpr(
             SCIPdebugPrintf("multiply variable %d = <%s>\n", address, SCIPvarGetName(probdata->vars[address]));
 
             assert(stackpos >= 1);
+            SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
             terms[0] = stack[stackpos-1];
             --stackpos;
 
@@ -475,10 +856,9 @@ SCIP_RETCODE makeExpr(
             SCIPdebugPrintf("multiply constant %g\n", constants[address]);
 
             assert(stackpos >= 1);
-            term1 = stack[stackpos-1];
-            --stackpos;
+            SCIP_CALL( stackGetSum(scip, stack, accs, stackpos-1) );
 
-            SCIP_CALL( exprAdd(scip, &e, constants[address], term1, 1.0, NULL, 0.0) );
+            SCIP_CALL( sumaccScale(scip, accs[stackpos-1], constants[address]) );
 
             break;
          }
@@ -488,12 +868,8 @@ SCIP_RETCODE makeExpr(
             SCIPdebugPrintf("multiply constant %g and add\n", constants[address]);
 
             assert(stackpos >= 2);
-            term1 = stack[stackpos-1];
-            --stackpos;
-            term2 = stack[stackpos-1];
-            --stackpos;
 
-            SCIP_CALL( exprAdd(scip, &e, constants[address], term1, 1.0, term2, 0.0) );
+            SCIP_CALL( stackAddTop(scip, stack, accs, &stackpos, 1.0, constants[address]) );
 
             break;
          }
@@ -505,8 +881,10 @@ SCIP_RETCODE makeExpr(
             SCIPdebugPrintf("divide\n");
 
             assert(stackpos >= 2);
+            SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
             term1 = stack[stackpos-1];
             --stackpos;
+            SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
             term2 = stack[stackpos-1];
             --stackpos;
 
@@ -529,6 +907,7 @@ SCIP_RETCODE makeExpr(
             SCIPdebugPrintf("divide variable %d = <%s>\n", address, SCIPvarGetName(probdata->vars[address]));
 
             assert(stackpos >= 1);
+            SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
             terms[0] = stack[stackpos-1];
             --stackpos;
 
@@ -549,10 +928,9 @@ SCIP_RETCODE makeExpr(
             assert(constants[address] != 0.0);
 
             assert(stackpos >= 1);
-            term1 = stack[stackpos-1];
-            --stackpos;
+            SCIP_CALL( stackGetSum(scip, stack, accs, stackpos-1) );
 
-            SCIP_CALL( exprAdd(scip, &e, 1.0/constants[address], term1, 1.0, NULL, 0.0) );
+            SCIP_CALL( sumaccScale(scip, accs[stackpos-1], 1.0/constants[address]) );
 
             break;
          }
@@ -562,10 +940,9 @@ SCIP_RETCODE makeExpr(
             SCIPdebugPrintf("negate\n");
 
             assert(stackpos >= 1);
-            term1 = stack[stackpos-1];
-            --stackpos;
+            SCIP_CALL( stackGetSum(scip, stack, accs, stackpos-1) );
 
-            SCIP_CALL( exprAdd(scip, &e, -1.0, term1, 1.0, NULL, 0.0) );
+            SCIP_CALL( sumaccScale(scip, accs[stackpos-1], -1.0) );
 
             break;
          }
@@ -620,8 +997,10 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("min\n");
 
                   assert(stackpos >= 2);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term2 = stack[stackpos-1];
                   --stackpos;
 
@@ -658,8 +1037,10 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("max\n");
 
                   assert(stackpos >= 2);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term2 = stack[stackpos-1];
                   --stackpos;
 
@@ -692,6 +1073,7 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("square\n");
 
                   assert(stackpos >= 1);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
 
@@ -705,6 +1087,7 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("exp\n");
 
                   assert(stackpos >= 1);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
 
@@ -718,6 +1101,7 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("log\n");
 
                   assert(stackpos >= 1);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
 
@@ -733,6 +1117,7 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("log10 = ln * 1/ln(10)\n");
 
                   assert(stackpos >= 1);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
 
@@ -753,6 +1138,7 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("log2 = ln * 1/ln(2)\n");
 
                   assert(stackpos >= 1);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
 
@@ -771,6 +1157,7 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("sqrt\n");
 
                   assert(stackpos >= 1);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
 
@@ -784,6 +1171,7 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("cos\n");
 
                   assert(stackpos >= 1);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
 
@@ -797,6 +1185,7 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("sin\n");
 
                   assert(stackpos >= 1);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
 
@@ -813,8 +1202,10 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("power\n");
 
                   assert(stackpos >= 2);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term2 = stack[stackpos-1];
                   --stackpos;
 
@@ -851,8 +1242,10 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("signpower\n");
 
                   assert(stackpos >= 2);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term2 = stack[stackpos-1];
                   --stackpos;
 
@@ -888,8 +1281,10 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("divide\n");
 
                   assert(stackpos >= 2);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term2 = stack[stackpos-1];
                   --stackpos;
 
@@ -909,6 +1304,7 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("abs\n");
 
                   assert(stackpos >= 1);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
 
@@ -921,10 +1317,17 @@ SCIP_RETCODE makeExpr(
                {
                   SCIPdebugPrintf("univariate polynomial of degree %d\n", nargs-2);
                   assert(nargs >= 0);
+
+                  /* coefficients and argument of the polynomial are needed as expressions */
+                  for( i = MAX(stackpos - MAX(nargs, 2), 0); i < stackpos; ++i )
+                  {
+                     SCIP_CALL( stackGetExpr(scip, stack, accs, i) );
+                  }
                   switch( nargs )
                   {
                      case 0:
                      {
+                        SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                         term1 = stack[stackpos-1];
                         --stackpos;
 
@@ -935,6 +1338,7 @@ SCIP_RETCODE makeExpr(
 
                      case 1: /* "constant" polynomial */
                      {
+                        SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                         e = stack[stackpos-1];
                         --stackpos;
 
@@ -965,6 +1369,7 @@ SCIP_RETCODE makeExpr(
                         {
                            assert(stackpos > 0);
 
+                           SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                            term1 = stack[stackpos-1];
                            assert(SCIPisExprValue(scip, term1));
 
@@ -1008,6 +1413,7 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("entropy\n");
 
                   assert(stackpos >= 1);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
 
@@ -1021,6 +1427,7 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("bool_not\n");
 
                   assert(stackpos >= 1);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
 
@@ -1050,8 +1457,10 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("bool_and\n");
 
                   assert(stackpos >= 2);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term2 = stack[stackpos-1];
                   --stackpos;
 
@@ -1125,8 +1534,10 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("bool_or\n");
 
                   assert(stackpos >= 2);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term2 = stack[stackpos-1];
                   --stackpos;
 
@@ -1200,8 +1611,10 @@ SCIP_RETCODE makeExpr(
                   SCIPdebugPrintf("bool_xor\n");
 
                   assert(stackpos >= 2);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term2 = stack[stackpos-1];
                   --stackpos;
 
@@ -1274,8 +1687,10 @@ SCIP_RETCODE makeExpr(
                   /* term2 -> term1, i.e., term1 || !term2 */
 
                   assert(stackpos >= 2);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term2 = stack[stackpos-1];
                   --stackpos;
 
@@ -1353,8 +1768,10 @@ SCIP_RETCODE makeExpr(
                   /* !(term1 ^ term2) */
 
                   assert(stackpos >= 2);
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term1 = stack[stackpos-1];
                   --stackpos;
+                  SCIP_CALL( stackGetExpr(scip, stack, accs, stackpos-1) );
                   term2 = stack[stackpos-1];
                   --stackpos;
 
@@ -1478,18 +1895,27 @@ SCIP_RETCODE makeExpr(
          {
             stacksize = SCIPcalcMemGrowSize(scip, stackpos+1);
             SCIP_CALL( SCIPreallocBufferArray(scip, &stack, stacksize) );
+            SCIP_CALL( SCIPreallocBufferArray(scip, &accs, stacksize) );
          }
          assert(stackpos < stacksize);
          stack[stackpos] = e;
+         accs[stackpos] = NULL;
          ++stackpos;
       }
    }
 
    /* there should be exactly one element on the stack, which will be the root of our expression tree */
    assert(stackpos == 1);
+   SCIP_CALL( stackGetExpr(scip, stack, accs, 0) );
    *expr = stack[0];
 
 TERMINATE:
+   for( i = 0; i < stackpos; ++i )
+      if( accs[i] != NULL )
+      {
+         SCIP_CALL( sumaccFree(scip, &accs[i], TRUE) );
+      }
+   SCIPfreeBufferArray(scip, &accs);
    SCIPfreeBufferArray(scip, &stack);
 
    return rc;
@@ -1512,18 +1938,27 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
    int i;
    SCIP_Real* coefs = NULL;
    int* indices = NULL;
-   int* nlflag;
+   int* nlflag = NULL;
    SCIP_VAR** consvars = NULL;
+   int* rowstart = NULL;
+   int* matcols = NULL;
+   SCIP_Real* matvals = NULL;
+   int* matnlflag = NULL;
+   SCIP_VAR** quadvars1 = NULL;
+   SCIP_VAR** quadvars2 = NULL;
+   SCIP_Real* quadcoefs = NULL;
+   int* qcol = NULL;
+   int* qrow = NULL;
    SCIP_CONS* con;
    int numSos1, numSos2, nzSos;
    SCIP_PROBDATA* probdata;
-   int* opcodes;
-   int* fields;
-   SCIP_Real* constants;
+   int* opcodes = NULL;
+   int* fields = NULL;
+   SCIP_Real* constants = NULL;
    int nindics;
-   int* indicrows;
-   int* indiccols;
-   int* indiconvals;
+   int* indicrows = NULL;
+   int* indiccols = NULL;
+   int* indiconvals = NULL;
    int indicidx;
    size_t namemem;
    SCIP_RETCODE rc = SCIP_OKAY;
@@ -1533,12 +1968,14 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
    SCIP_Real infbound;
    SCIP_Bool haveinfbound;
    int nboundschanged = 0;
+   double starttime;
    
    assert(scip != NULL);
    assert(gmo != NULL);
 
    gev = (gevHandle_t) gmoEnvironment(gmo);
    assert(gev != NULL);
+   starttime = gevTimeDiffStart(gev);
 
    /* we want a real objective function, if it is linear, otherwise keep the GAMS single-variable-objective? */
    gmoObjReformSet(gmo, 1);
@@ -1554,6 +1991,9 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
    /* we want to start indexing at 0 */
    gmoIndexBaseSet(gmo, 0);
 
+   /* we want quadratic equations as Q matrix and linear coefficients, so they do not need to be rebuilt from instructions */
+   gmoUseQSet(gmo, 1);
+
    /* we want GMO to use SCIP's value for infinity */
    gmoPinfSet(gmo,  SCIPinfinity(scip));
    gmoMinfSet(gmo, -SCIPinfinity(scip));
@@ -1836,17 +2276,43 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
    }
    
    /* setup regular constraints */
-   SCIP_CALL( SCIPallocBufferArray(scip, &indices, gmoN(gmo)) );
+   SCIP_CALL_TERMINATE( rc, SCIPallocBufferArray(scip, &indices, gmoN(gmo)), TERMINATE );
    indicidx = 0;
-   
+
+   /* get the whole row-wise matrix at once, the constraints are then created from slices of it */
+   SCIP_CALL_TERMINATE( rc, SCIPallocMemoryArray(scip, &rowstart, gmoM(gmo)+1), TERMINATE );
+   SCIP_CALL_TERMINATE( rc, SCIPallocMemoryArray(scip, &matcols, gmoNZ(gmo)+1), TERMINATE );
+   SCIP_CALL_TERMINATE( rc, SCIPallocMemoryArray(scip, &matvals, gmoNZ(gmo)+1), TERMINATE );
+   if( gmoNLNZ(gmo) > 0 )
+   {
+      SCIP_CALL_TERMINATE( rc, SCIPallocMemoryArray(scip, &matnlflag, gmoNZ(gmo)+1), TERMINATE );
+   }
+   (void) gmoGetMatrixRow(gmo, rowstart, matcols, matvals, matnlflag);
+
+   /* alloc some memory, if quadratic */
+   if( gmoMaxQNZ(gmo) > 0 || gmoGetObjOrder(gmo) == (int) gmoorder_Q )
+   {
+      int maxqnz;
+
+      maxqnz = gmoMaxQNZ(gmo);
+      if( gmoGetObjOrder(gmo) == (int) gmoorder_Q )
+         maxqnz = MAX(maxqnz, gmoObjQNZ(gmo));
+
+      SCIP_CALL_TERMINATE( rc, SCIPallocBufferArray(scip, &quadvars1, maxqnz), TERMINATE );
+      SCIP_CALL_TERMINATE( rc, SCIPallocBufferArray(scip, &quadvars2, maxqnz), TERMINATE );
+      SCIP_CALL_TERMINATE( rc, SCIPallocBufferArray(scip, &quadcoefs, maxqnz), TERMINATE );
+      SCIP_CALL_TERMINATE( rc, SCIPallocBufferArray(scip, &qcol, maxqnz), TERMINATE );
+      SCIP_CALL_TERMINATE( rc, SCIPallocBufferArray(scip, &qrow, maxqnz), TERMINATE );
+   }
+
    /* alloc some memory, if nonlinear */
    if( gmoNLNZ(gmo) > 0 || objnonlinear )
    {
-      SCIP_CALL( SCIPallocBufferArray(scip, &nlflag, gmoN(gmo)) );
+      SCIP_CALL_TERMINATE( rc, SCIPallocBufferArray(scip, &nlflag, gmoN(gmo)), TERMINATE );
 
-      SCIP_CALL( SCIPallocBufferArray(scip, &opcodes, gmoNLCodeSizeMaxRow(gmo)+1) );
-      SCIP_CALL( SCIPallocBufferArray(scip, &fields, gmoNLCodeSizeMaxRow(gmo)+1) );
-      SCIP_CALL( SCIPduplicateBufferArray(scip, &constants, (double*)gmoPPool(gmo), gmoNLConst(gmo)) );
+      SCIP_CALL_TERMINATE( rc, SCIPallocBufferArray(scip, &opcodes, gmoNLCodeSizeMaxRow(gmo)+1), TERMINATE );
+      SCIP_CALL_TERMINATE( rc, SCIPallocBufferArray(scip, &fields, gmoNLCodeSizeMaxRow(gmo)+1), TERMINATE );
+      SCIP_CALL_TERMINATE( rc, SCIPduplicateBufferArray(scip, &constants, (double*)gmoPPool(gmo), gmoNLConst(gmo)), TERMINATE );
 
       /* translate special GAMS constants into SCIP variants (gmo does not seem to do this...) */
       for( i = 0; i < gmoNLConst(gmo); ++i )
@@ -1900,16 +2366,20 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
             break;
          case gmoequ_X:
             SCIPerrorMessage("External functions not supported by SCIP.\n");
-            return SCIP_INVALIDDATA;
+            rc = SCIP_INVALIDDATA;
+            goto TERMINATE;
          case gmoequ_C:
             SCIPerrorMessage("Conic constraints not supported by SCIP interface.\n");
-            return SCIP_INVALIDDATA;
+            rc = SCIP_INVALIDDATA;
+            goto TERMINATE;
          case gmoequ_B:
             SCIPerrorMessage("Logic constraints not supported by SCIP interface yet.\n");
-            return SCIP_INVALIDDATA;
+            rc = SCIP_INVALIDDATA;
+            goto TERMINATE;
          default:
             SCIPerrorMessage("unknown equation type.\n");
-            return SCIP_INVALIDDATA;
+            rc = SCIP_INVALIDDATA;
+            goto TERMINATE;
       }
 
       if( gmoDict(gmo) )
@@ -1927,12 +2397,13 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
          case gmoorder_L:
          {
             /* linear constraint */
-            int j, nz, nlnz;
-            (void) gmoGetRowSparse(gmo, i, indices, coefs, NULL, &nz, &nlnz);
-            assert(nlnz == 0);
+            int j, nz;
+            SCIP_Real* rowvals;
 
+            nz = rowstart[i+1] - rowstart[i];
+            rowvals = &matvals[rowstart[i]];
             for( j = 0; j < nz; ++j )
-               consvars[j] = vars[indices[j]];
+               consvars[j] = vars[matcols[rowstart[i]+j]];
 
             /* create indicator constraint, if we are at one */
             if( indicidx < nindics && indicrows[indicidx] == i ) /*lint !e613*/
@@ -1943,52 +2414,78 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
                if( SCIPvarGetType(binvar) != SCIP_VARTYPE_BINARY )
                {
                   SCIPerrorMessage("Indicator variable <%s> is not of binary type.\n", SCIPvarGetName(binvar));
-                  return SCIP_ERROR;
+                  rc = SCIP_ERROR;
+                  goto TERMINATE;
                }
 
                assert(indiconvals[indicidx] == 0 || indiconvals[indicidx] == 1); /*lint !e613*/
                if( indiconvals[indicidx] == 0 ) /*lint !e613*/
                {
-                  SCIP_CALL( SCIPgetNegatedVar(scip, binvar, &binvar) );
+                  SCIP_CALL_TERMINATE( rc, SCIPgetNegatedVar(scip, binvar, &binvar), TERMINATE );
                }
 
                if( !SCIPisInfinity(scip, rhs) )
                {
-                  SCIP_CALL( SCIPcreateConsIndicator(scip, &con, buffer, binvar, nz, consvars, coefs, rhs,
-                     TRUE, TRUE, TRUE, TRUE, TRUE, FALSE, FALSE, FALSE, FALSE) );
+                  SCIP_CALL_TERMINATE( rc, SCIPcreateConsIndicator(scip, &con, buffer, binvar, nz, consvars, rowvals, rhs,
+                     TRUE, TRUE, TRUE, TRUE, TRUE, FALSE, FALSE, FALSE, FALSE), TERMINATE );
 
                   if( !SCIPisInfinity(scip, -lhs) )
                   {
-                     SCIP_CALL( SCIPaddCons(scip, con) );
+                     SCIP_CALL_TERMINATE( rc, SCIPaddCons(scip, con), TERMINATE );
                      SCIPdebugMessage("added constraint ");
                      SCIPdebug( SCIPprintCons(scip, con, NULL) );
-                     SCIP_CALL( SCIPreleaseCons(scip, &con) );
+                     SCIP_CALL_TERMINATE( rc, SCIPreleaseCons(scip, &con), TERMINATE );
                      con = NULL;
                   }
                }
                if( !SCIPisInfinity(scip, -lhs) )
                {
                   for( j = 0; j < nz; ++j )
-                     coefs[j] = -coefs[j];
-                  SCIP_CALL( SCIPcreateConsIndicator(scip, &con, buffer, binvar, nz, consvars, coefs, -lhs,
-                     TRUE, TRUE, TRUE, TRUE, TRUE, FALSE, FALSE, FALSE, FALSE) );
+                     rowvals[j] = -rowvals[j];
+                  SCIP_CALL_TERMINATE( rc, SCIPcreateConsIndicator(scip, &con, buffer, binvar, nz, consvars, rowvals, -lhs,
+                     TRUE, TRUE, TRUE, TRUE, TRUE, FALSE, FALSE, FALSE, FALSE), TERMINATE );
                }
 
                ++indicidx;
             }
             else
             {
-               SCIP_CALL( SCIPcreateConsLinear(scip, &con, buffer, nz, consvars, coefs, lhs, rhs,
-                     TRUE, TRUE, TRUE, TRUE, TRUE, FALSE, FALSE, FALSE, FALSE, FALSE) );
+               SCIP_CALL_TERMINATE( rc, SCIPcreateConsLinear(scip, &con, buffer, nz, consvars, rowvals, lhs, rhs,
+                     TRUE, TRUE, TRUE, TRUE, TRUE, FALSE, FALSE, FALSE, FALSE, FALSE), TERMINATE );
             }
 
             break;
          }
-         
+
+         case gmoorder_Q:
+         {
+            /* quadratic constraint: all Jacobian entries are linear coefficients, GMO gives twice the coefficient of squares */
+            int j, nz, qnz;
+
+            nz = rowstart[i+1] - rowstart[i];
+            for( j = 0; j < nz; ++j )
+               consvars[j] = vars[matcols[rowstart[i]+j]];
+
+            qnz = gmoGetRowQNZOne(gmo, i);
+            (void) gmoGetRowQ(gmo, i, qcol, qrow, quadcoefs);
+            for( j = 0; j < qnz; ++j )
+            {
+               quadvars1[j] = vars[qcol[j]];
+               quadvars2[j] = vars[qrow[j]];
+               if( qcol[j] == qrow[j] )
+                  quadcoefs[j] /= 2.0;
+            }
+
+            SCIP_CALL_TERMINATE( rc, SCIPcreateConsBasicQuadraticNonlinear(scip, &con, buffer, nz, consvars, &matvals[rowstart[i]],
+                  qnz, quadvars1, quadvars2, quadcoefs, lhs, rhs), TERMINATE );
+
+            break;
+         }
+
          case gmoorder_NL:
          {
             /* nonlinear constraint */
-            int j, nz, nlnz;
+            int k;
             int codelen;
             SCIP_EXPR* expr;
 
@@ -2000,19 +2497,19 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
                SCIPinfoMessage(scip, NULL, "Error processing nonlinear instructions of equation %s.\n", buffer);
                goto TERMINATE;
             }
-            SCIP_CALL( rc );
+            if( rc != SCIP_OKAY )
+               goto TERMINATE;
 
-            SCIP_CALL( SCIPcreateConsBasicNonlinear(scip, &con, buffer, expr, lhs, rhs) );
-            SCIP_CALL( SCIPreleaseExpr(scip, &expr) );
+            SCIP_CALL_TERMINATE( rc, SCIPcreateConsBasicNonlinear(scip, &con, buffer, expr, lhs, rhs), TERMINATE );
+            SCIP_CALL_TERMINATE( rc, SCIPreleaseExpr(scip, &expr), TERMINATE );
 
             /* add linear part */
-            assert(nlflag != NULL);
-            (void) gmoGetRowSparse(gmo, i, indices, coefs, nlflag, &nz, &nlnz);
-            for( j = 0; j < nz; ++j )
+            assert(matnlflag != NULL);
+            for( k = rowstart[i]; k < rowstart[i+1]; ++k )
             {
-               if( !nlflag[j] )
+               if( !matnlflag[k] )
                {
-                  SCIP_CALL( SCIPaddLinearVarNonlinear(scip, con, vars[indices[j]], coefs[j]) );
+                  SCIP_CALL_TERMINATE( rc, SCIPaddLinearVarNonlinear(scip, con, vars[matcols[k]], matvals[k]), TERMINATE );
                }
             }
 
@@ -2021,20 +2518,22 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
 
          default:
             SCIPerrorMessage("Unexpected equation order.\n");
-            return SCIP_INVALIDDATA;
+            rc = SCIP_INVALIDDATA;
+            goto TERMINATE;
       }
       
       assert(con != NULL);
-      SCIP_CALL( SCIPaddCons(scip, con) );      
+      SCIP_CALL_TERMINATE( rc, SCIPaddCons(scip, con), TERMINATE );      
       SCIPdebugMessage("added constraint ");
       SCIPdebug( SCIPprintCons(scip, con, NULL) );
-      SCIP_CALL( SCIPreleaseCons(scip, &con) );
+      SCIP_CALL_TERMINATE( rc, SCIPreleaseCons(scip, &con), TERMINATE );
 
       /* @todo do something about this */
       if( indicidx < nindics && indicrows[indicidx] == i ) /*lint !e613*/
       {
          SCIPerrorMessage("Only linear constraints can be indicatored, currently.\n");
-         return SCIP_ERROR;
+         rc = SCIP_ERROR;
+         goto TERMINATE;
       }
    }
    
@@ -2047,26 +2546,15 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
       int codelen;
       SCIP_EXPR* expr;
       
-      assert(gmoGetObjOrder(gmo) == (int) gmoorder_NL);
+      assert(gmoGetObjOrder(gmo) == (int) gmoorder_NL || gmoGetObjOrder(gmo) == (int) gmoorder_Q);
 
-      SCIP_CALL( SCIPcreateVar(scip, &probdata->objvar, "xobj", -SCIPinfinity(scip), SCIPinfinity(scip), 1.0, SCIP_VARTYPE_CONTINUOUS, TRUE, FALSE, NULL, NULL, NULL, NULL, NULL) );
-      SCIP_CALL( SCIPaddVar(scip, probdata->objvar) );
+      SCIP_CALL_TERMINATE( rc, SCIPcreateVar(scip, &probdata->objvar, "xobj", -SCIPinfinity(scip), SCIPinfinity(scip), 1.0, SCIP_VARTYPE_CONTINUOUS, TRUE, FALSE, NULL, NULL, NULL, NULL, NULL), TERMINATE );
+      SCIP_CALL_TERMINATE( rc, SCIPaddVar(scip, probdata->objvar), TERMINATE );
       SCIPdebugMessage("added objective variable ");
       SCIPdebug( SCIPprintVar(scip, probdata->objvar, NULL) );
 
       assert(nlflag != NULL);
 
-      objfactor = -1.0 / gmoObjJacVal(gmo);
-
-      (void) gmoDirtyGetObjFNLInstr(gmo, &codelen, opcodes, fields);
-      rc = makeExpr(scip, gmo, codelen, opcodes, fields, constants, &logiccount, &expr);
-      if( rc == SCIP_READERROR )
-      {
-         SCIPinfoMessage(scip, NULL, "Error processing nonlinear instructions of objective %s.\n", gmoGetObjName(gmo, buffer));
-         goto TERMINATE;
-      }
-      SCIP_CALL( rc );
-
       if( gmoSense(gmo) != (int) gmoObj_Max )
       {
          lhs = -SCIPinfinity(scip);
@@ -2078,52 +2566,89 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
          rhs = SCIPinfinity(scip);
       }
 
-      if( objfactor != 1.0 )
+      if( gmoGetObjOrder(gmo) == (int) gmoorder_Q )
       {
-         SCIP_EXPR* tmp;
+         /* quadratic objective: linear part and Q matrix from GMO, plus -objvar */
+         int qnz;
 
-         SCIP_CALL( exprAdd(scip, &tmp, objfactor, expr, 1.0, NULL, 0.0) );
-         expr = tmp;
-      }
+         (void) gmoGetObjSparse(gmo, indices, coefs, nlflag, &nz, &nlnz);
+         for( j = 0; j < nz; ++j )
+            consvars[j] = vars[indices[j]];
 
-      SCIP_CALL( SCIPcreateConsBasicNonlinear(scip, &con, "objective", expr, lhs, rhs) );
-      SCIP_CALL( SCIPreleaseExpr(scip, &expr) );
+         qnz = gmoObjQNZ(gmo);
+         (void) gmoGetObjQ(gmo, qcol, qrow, quadcoefs);
+         for( j = 0; j < qnz; ++j )
+         {
+            quadvars1[j] = vars[qcol[j]];
+            quadvars2[j] = vars[qrow[j]];
+            if( qcol[j] == qrow[j] )
+               quadcoefs[j] /= 2.0;
+         }
 
-      /* add linear part */
-      (void) gmoGetObjSparse(gmo, indices, coefs, nlflag, &nz, &nlnz);
-      for( j = 0; j < nz; ++j )
+         SCIP_CALL_TERMINATE( rc, SCIPcreateConsBasicQuadraticNonlinear(scip, &con, "objective", nz, consvars, coefs,
+               qnz, quadvars1, quadvars2, quadcoefs, lhs, rhs), TERMINATE );
+      }
+      else
       {
-         if( !nlflag[j] )
+         objfactor = -1.0 / gmoObjJacVal(gmo);
+
+         (void) gmoDirtyGetObjFNLInstr(gmo, &codelen, opcodes, fields);
+         rc = makeExpr(scip, gmo, codelen, opcodes, fields, constants, &logiccount, &expr);
+         if( rc == SCIP_READERROR )
          {
-            SCIP_CALL( SCIPaddLinearVarNonlinear(scip, con, vars[indices[j]], coefs[j]) );
+            SCIPinfoMessage(scip, NULL, "Error processing nonlinear instructions of objective %s.\n", gmoGetObjName(gmo, buffer));
+            goto TERMINATE;
+         }
+         if( rc != SCIP_OKAY )
+            goto TERMINATE;
+
+         if( objfactor != 1.0 )
+         {
+            SCIP_EXPR* tmp;
+
+            SCIP_CALL_TERMINATE( rc, exprAdd(scip, &tmp, objfactor, expr, 1.0, NULL, 0.0), TERMINATE );
+            expr = tmp;
+         }
+
+         SCIP_CALL_TERMINATE( rc, SCIPcreateConsBasicNonlinear(scip, &con, "objective", expr, lhs, rhs), TERMINATE );
+         SCIP_CALL_TERMINATE( rc, SCIPreleaseExpr(scip, &expr), TERMINATE );
+
+         /* add linear part */
+         (void) gmoGetObjSparse(gmo, indices, coefs, nlflag, &nz, &nlnz);
+         for( j = 0; j < nz; ++j )
+         {
+            if( !nlflag[j] )
+            {
+               SCIP_CALL_TERMINATE( rc, SCIPaddLinearVarNonlinear(scip, con, vars[indices[j]], coefs[j]), TERMINATE );
+            }
          }
       }
 
-      SCIP_CALL( SCIPaddLinearVarNonlinear(scip, con, probdata->objvar, -1.0) );
+      SCIP_CALL_TERMINATE( rc, SCIPaddLinearVarNonlinear(scip, con, probdata->objvar, -1.0), TERMINATE );
 
-      SCIP_CALL( SCIPaddCons(scip, con) );
+      SCIP_CALL_TERMINATE( rc, SCIPaddCons(scip, con), TERMINATE );
       SCIPdebugMessage("added objective constraint ");
       SCIPdebug( SCIPprintCons(scip, con, NULL) );
-      SCIP_CALL( SCIPreleaseCons(scip, &con) );
+      SCIP_CALL_TERMINATE( rc, SCIPreleaseCons(scip, &con), TERMINATE );
    }
    else if( !SCIPisZero(scip, gmoObjConst(gmo)) )
    {
       /* handle constant term in linear objective by adding a fixed variable */
-      SCIP_CALL( SCIPcreateVar(scip, &probdata->objconst, "objconst", 1.0, 1.0, gmoObjConst(gmo), SCIP_VARTYPE_CONTINUOUS, TRUE, FALSE, NULL, NULL, NULL, NULL, NULL) );
-      SCIP_CALL( SCIPaddVar(scip, probdata->objconst) );
+      SCIP_CALL_TERMINATE( rc, SCIPcreateVar(scip, &probdata->objconst, "objconst", 1.0, 1.0, gmoObjConst(gmo), SCIP_VARTYPE_CONTINUOUS, TRUE, FALSE, NULL, NULL, NULL, NULL, NULL), TERMINATE );
+      SCIP_CALL_TERMINATE( rc, SCIPaddVar(scip, probdata->objconst), TERMINATE );
       SCIPdebugMessage("added variable for objective constant: ");
       SCIPdebug( SCIPprintVar(scip, probdata->objconst, NULL) );
    }
 
    if( gmoSense(gmo) == (int) gmoObj_Max )
    {
-      SCIP_CALL( SCIPsetObjsense(scip, SCIP_OBJSENSE_MAXIMIZE) );
+      SCIP_CALL_TERMINATE( rc, SCIPsetObjsense(scip, SCIP_OBJSENSE_MAXIMIZE), TERMINATE );
    }
    
    /* set objective limit, if enabled */
    if( gevGetIntOpt(gev, gevUseCutOff) )
    {
-      SCIP_CALL( SCIPsetObjlimit(scip, gevGetDblOpt(gev, gevCutOff)) );
+      SCIP_CALL_TERMINATE( rc, SCIPsetObjlimit(scip, gevGetDblOpt(gev, gevCutOff)), TERMINATE );
    }
 
    /* handle initial solution values */
@@ -2148,18 +2673,18 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
          if( mipstart == 2 )
          {
             /* with this, SCIP will only check feasibility */
-            SCIP_CALL( SCIPcreateOrigSol(scip, &sol, NULL) );
+            SCIP_CALL_TERMINATE( rc, SCIPcreateOrigSol(scip, &sol, NULL), TERMINATE );
          }
          else
          {
             /* with this, SCIP will try to find a feasible solution close by to the initial values */
-            SCIP_CALL( SCIPcreatePartialSol(scip, &sol, NULL) );
+            SCIP_CALL_TERMINATE( rc, SCIPcreatePartialSol(scip, &sol, NULL), TERMINATE );
          }
 
-         SCIP_CALL( SCIPallocBufferArray(scip, &vals, gmoN(gmo)) );
+         SCIP_CALL_TERMINATE( rc, SCIPallocBufferArray(scip, &vals, gmoN(gmo)), TERMINATE );
          (void) gmoGetVarL(gmo, vals);
 
-         SCIP_CALL( SCIPsetSolVals(scip, sol, gmoN(gmo), probdata->vars, vals) );
+         SCIP_CALL_TERMINATE( rc, SCIPsetSolVals(scip, sol, gmoN(gmo), probdata->vars, vals), TERMINATE );
 
          /* if we have extra variable for objective, then need to set its value too */
          if( probdata->objvar != NULL )
@@ -2169,17 +2694,17 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
             (void) gmoEvalFuncObj(gmo, vals, &objval, &numErr);
             if( numErr == 0 )
             {
-               SCIP_CALL( SCIPsetSolVal(scip, sol, probdata->objvar, objval) );
+               SCIP_CALL_TERMINATE( rc, SCIPsetSolVal(scip, sol, probdata->objvar, objval), TERMINATE );
             }
          }
 
          /* if we have extra variable for objective constant, then need to set its value to 1.0 here too */
          if( probdata->objconst != NULL )
          {
-            SCIP_CALL( SCIPsetSolVal(scip, sol, probdata->objconst, 1.0) );
+            SCIP_CALL_TERMINATE( rc, SCIPsetSolVal(scip, sol, probdata->objconst, 1.0), TERMINATE );
          }
 
-         SCIP_CALL( SCIPaddSolFree(scip, &sol, &stored) );
+         SCIP_CALL_TERMINATE( rc, SCIPaddSolFree(scip, &sol, &stored), TERMINATE );
          assert(stored);
 
          SCIPfreeBufferArray(scip, &vals);
@@ -2204,7 +2729,7 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
          if( mipstart == 4 )
             tryint = gevGetDblOpt(gev, gevTryInt);
 
-         SCIP_CALL( SCIPcreatePartialSol(scip, &sol, NULL) );
+         SCIP_CALL_TERMINATE( rc, SCIPcreatePartialSol(scip, &sol, NULL), TERMINATE );
 
          nknown = 0;
          for( i = 0; i < gmoN(gmo); ++i )
@@ -2212,7 +2737,7 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
             if( mipstart == 1 && (gmoGetVarTypeOne(gmo, i) == gmovar_B || gmoGetVarTypeOne(gmo, i) == gmovar_I || gmoGetVarTypeOne(gmo, i) == gmovar_SI) )
             {
                /* 1: set all integer variables */
-               SCIP_CALL( SCIPsetSolVal(scip, sol, probdata->vars[i], gmoGetVarLOne(gmo, i)) );
+               SCIP_CALL_TERMINATE( rc, SCIPsetSolVal(scip, sol, probdata->vars[i], gmoGetVarLOne(gmo, i)), TERMINATE );
                ++nknown;
             }
 
@@ -2224,7 +2749,7 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
                val = gmoGetVarLOne(gmo, i);
                if( fabs(round(val)-val) <= tryint )
                {
-                  SCIP_CALL( SCIPsetSolVal(scip, sol, probdata->vars[i], val) );
+                  SCIP_CALL_TERMINATE( rc, SCIPsetSolVal(scip, sol, probdata->vars[i], val), TERMINATE );
                   ++nknown;
                }
             }
@@ -2233,10 +2758,10 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
          /* if we have extra variable for objective constant, then can set its value to 1.0 here too */
          if( probdata->objconst != NULL )
          {
-            SCIP_CALL( SCIPsetSolVal(scip, sol, probdata->objconst, 1.0) );
+            SCIP_CALL_TERMINATE( rc, SCIPsetSolVal(scip, sol, probdata->objconst, 1.0), TERMINATE );
          }
 
-         SCIP_CALL( SCIPaddSolFree(scip, &sol, &stored) );
+         SCIP_CALL_TERMINATE( rc, SCIPaddSolFree(scip, &sol, &stored), TERMINATE );
          assert(stored);
 
          SCIPinfoMessage(scip, NULL, "Passed partial solution with values for %d variables (%.1f%%) to SCIP.", nknown, 100.0*(double)nknown/gmoN(gmo));
@@ -2250,6 +2775,8 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
       }
    }
 
+   SCIPinfoMessage(scip, NULL, "Problem setup took %.2f seconds.\n", gevTimeDiffStart(gev) - starttime);
+
    if( namemem > 1024 * 1024 && nindics == 0 )
    {
       namemem <<= 1;  /* transformed problem has copy of names, so duplicate estimate */
@@ -2267,10 +2794,10 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
       int nlabels = 0;
       SCIP_Bool dispstat;
 
-      SCIP_CALL( SCIPcreateDecomp(scip, &decomp, maxstage, TRUE, FALSE) );
+      SCIP_CALL_TERMINATE( rc, SCIPcreateDecomp(scip, &decomp, maxstage, TRUE, FALSE), TERMINATE );
 
-      SCIP_CALL( SCIPallocBufferArray(scip, &labeledvars, gmoN(gmo)) );
-      SCIP_CALL( SCIPallocBufferArray(scip, &labels, gmoN(gmo)) );
+      SCIP_CALL_TERMINATE( rc, SCIPallocBufferArray(scip, &labeledvars, gmoN(gmo)), TERMINATE );
+      SCIP_CALL_TERMINATE( rc, SCIPallocBufferArray(scip, &labels, gmoN(gmo)), TERMINATE );
 
       for( i = 0; i < gmoN(gmo); ++i )
       {
@@ -2288,24 +2815,30 @@ SCIP_RETCODE SCIPcreateProblemReaderGmo(
          ++nlabels;
       }
 
-      SCIP_CALL( SCIPdecompSetVarsLabels(decomp, labeledvars, labels, nlabels) );
-      SCIP_CALL( SCIPcomputeDecompConsLabels(scip, decomp, SCIPgetConss(scip), SCIPgetNConss(scip)) );
+      SCIP_CALL_TERMINATE( rc, SCIPdecompSetVarsLabels(decomp, labeledvars, labels, nlabels), TERMINATE );
+      SCIP_CALL_TERMINATE( rc, SCIPcomputeDecompConsLabels(scip, decomp, SCIPgetConss(scip), SCIPgetNConss(scip)), TERMINATE );
 
-      SCIP_CALL( SCIPgetBoolParam(scip, "display/statistics", &dispstat) );
+      SCIP_CALL_TERMINATE( rc, SCIPgetBoolParam(scip, "display/statistics", &dispstat), TERMINATE );
       if( dispstat )
       {
          char decompstats[SCIP_MAXSTRLEN];
-         SCIP_CALL( SCIPcomputeDecompStats(scip, decomp, TRUE) );
+         SCIP_CALL_TERMINATE( rc, SCIPcomputeDecompStats(scip, decomp, TRUE), TERMINATE );
          SCIPinfoMessage(scip, NULL, "%s", SCIPdecompPrintStats(decomp, decompstats) );
       }
 
-      SCIP_CALL( SCIPaddDecomp(scip, decomp) );
+      SCIP_CALL_TERMINATE( rc, SCIPaddDecomp(scip, decomp), TERMINATE );
 
       SCIPfreeBufferArray(scip, &labels);
       SCIPfreeBufferArray(scip, &labeledvars);
    }
 
 TERMINATE:
+   gmoUseQSet(gmo, 0);
+
+   SCIPfreeMemoryArrayNull(scip, &rowstart);
+   SCIPfreeMemoryArrayNull(scip, &matcols);
+   SCIPfreeMemoryArrayNull(scip, &matvals);
+   SCIPfreeMemoryArrayNull(scip, &matnlflag);
    SCIPfreeBufferArrayNull(scip, &coefs);
    SCIPfreeBufferArrayNull(scip, &indices);
    SCIPfreeBufferArrayNull(scip, &consvars);
@@ -2316,6 +2849,11 @@ TERMINATE:
    SCIPfreeBufferArrayNull(scip, &indicrows);
    SCIPfreeBufferArrayNull(scip, &indiccols);
    SCIPfreeBufferArrayNull(scip, &indiconvals);
+   SCIPfreeBufferArrayNull(scip, &quadvars1);
+   SCIPfreeBufferArrayNull(scip, &quadvars2);
+   SCIPfreeBufferArrayNull(scip, &quadcoefs);
+   SCIPfreeBufferArrayNull(scip, &qcol);
+   SCIPfreeBufferArrayNull(scip, &qrow);
 
    return rc;
 }
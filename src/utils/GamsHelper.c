@@ -56,3 +56,56 @@ void GAMSsetNumThreads(
    }
 #endif
 }
+
+void GAMSsetNumThreadsLocal(
+   int                 nthreads            /**< number of threads for OpenMP */
+)
+{
+#ifdef _OPENMP
+   /* the nthreads-var ICV belongs to the data environment of the calling thread */
+   omp_set_num_threads(nthreads);
+#endif
+}
+
+uint64_t GAMShashBytes(
+   uint64_t            h,                  /**< hash to continue, GAMS_FNV1A_INIT to start a new one */
+   const void*         data,               /**< bytes to hash */
+   size_t              len                 /**< number of bytes */
+)
+{
+   const unsigned char* bytes = (const unsigned char*)data;
+   size_t k;
+
+   for( k = 0; k < len; ++k )
+   {
+      h ^= bytes[k];
+      h *= UINT64_C(1099511628211);
+   }
+
+   return h;
+}
+
+uint64_t GAMShashInt(
+   uint64_t            h,                  /**< hash to continue, GAMS_FNV1A_INIT to start a new one */
+   int                 val                 /**< value to hash */
+)
+{
+   return GAMShashBytes(h, &val, sizeof(int));
+}
+
+uint64_t GAMShashDoubles(
+   uint64_t            h,                  /**< hash to continue, GAMS_FNV1A_INIT to start a new one */
+   const double*       vals,               /**< values to hash */
+   size_t              nvals               /**< number of values */
+)
+{
+   size_t i;
+
+   for( i = 0; i < nvals; ++i )
+   {
+      double v = vals[i] == 0.0 ? 0.0 : vals[i];
+      h = GAMShashBytes(h, &v, sizeof(double));
+   }
+
+   return h;
+}
@@ -9,10 +9,16 @@
 #ifndef GAMSHELPER_H_
 #define GAMSHELPER_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** initial value of an FNV-1a hash */
+#define GAMS_FNV1A_INIT UINT64_C(14695981039346656037)
+
 typedef struct gevRec* gevHandle_t;
 
 /** sets number of OpenMP/GotoBlas/Apple threads */
@@ -21,6 +27,42 @@ void GAMSsetNumThreads(
    int                 nthreads            /**< number of threads for OpenMP/GotoBlas */
 );
 
+/** sets number of OpenMP threads for parallel regions started by the calling thread only
+ *
+ * Meant for worker threads started by a solver, which do not inherit the OpenMP setting of the main thread.
+ * Process-wide settings (GotoBlas, Apple environment variables) are not modified, so GAMSsetNumThreads
+ * should have been called on the main thread before.
+ */
+void GAMSsetNumThreadsLocal(
+   int                 nthreads            /**< number of threads for OpenMP */
+);
+
+/** continues an FNV-1a hash with a sequence of bytes
+ *
+ * The hash has 64 bits on all platforms, so that fingerprints written to files do not depend on the word size.
+ */
+uint64_t GAMShashBytes(
+   uint64_t            h,                  /**< hash to continue, GAMS_FNV1A_INIT to start a new one */
+   const void*         data,               /**< bytes to hash */
+   size_t              len                 /**< number of bytes */
+);
+
+/** continues an FNV-1a hash with an integer */
+uint64_t GAMShashInt(
+   uint64_t            h,                  /**< hash to continue, GAMS_FNV1A_INIT to start a new one */
+   int                 val                 /**< value to hash */
+);
+
+/** continues an FNV-1a hash with a sequence of doubles
+ *
+ * -0.0 is hashed as 0.0, so that equal values have equal hashes.
+ */
+uint64_t GAMShashDoubles(
+   uint64_t            h,                  /**< hash to continue, GAMS_FNV1A_INIT to start a new one */
+   const double*       vals,               /**< values to hash */
+   size_t              nvals               /**< number of values */
+);
+
 #ifdef __cplusplus
 }
 #endif